@@ -24,10 +24,18 @@
 
 #include	"x_config.h"
 
-#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1) && (halHAS_DS18X20 == 1)
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS18X20 == 1)
 
 #include	"ds18x20.h"
 #include	"ds2482.h"
+#include	"ds2482stats.h"
+#include	"ds2482health.h"
+#include	"owpolicy.h"
+#include	"owxact.h"
+#include	"ds2482arb.h"
+#include	"owfamily.h"
+#include	"ds28ea00.h"
+#include	"ds2409.h"
 #include	"endpoints.h"
 
 #include	"syslog.h"
@@ -49,9 +57,18 @@
 #define	debugPARAM					(debugFLAG & 0x4000)
 #define	debugRESULT					(debugFLAG & 0x8000)
 
+#define	ds18x20GROUP(Idx)			ds2409GROUP(psDS18X20[Idx].Ch, psDS18X20[Idx].ROM)
+
 ds18x20_t *	psDS18X20		= NULL ;
 complex_t	sDS18X20Func	= { .read = ds18x20GetTemperature, .mode = NULL } ;
 uint8_t		Fam10_28Count	= 0 ;
+static	uint8_t	SweepMask		= 0 ;				// channels (not quarantined) in current sweep
+static	uint8_t *	SweepOrder	= NULL ;				// sensor indexes sorted by channel & branch
+static	uint8_t		EnumIdx		= 0 ;					// next free entry while enumerating
+static	uint8_t		TrigMask	= 0 ;					// channels with a conversion triggered
+static	uint8_t		PowerMask	= 0 ;					// channels with SPU armed (parasitic sensors)
+static	uint8_t		PollMask	= 0 ;					// channels where conversion complete can be polled
+static	TickType_t	ConvDue[ds2482NUM_CHAN] ;			// latest conversion completion per channel
 
 // ############################ Forward declaration of local functions #############################
 
@@ -59,85 +76,74 @@ uint8_t		Fam10_28Count	= 0 ;
 // ############################### ds18x20 (Family 10 & 28) support ################################
 
 void	ds18x20PrintInfo(ds18x20_t * psDS18X20) {
-	ds2482PrintROM(&psDS18X20->ROM) ;
+	ds2482PrintROM(psDS18X20->ROM) ;
 	PRINT("  Tlsb=%02X  Tmsb=%02X  Thi=%02X  Tlo=%02X",
 			psDS18X20->Tlsb, psDS18X20->Tmsb, psDS18X20->Thi, psDS18X20->Tlo) ;
-	if (psDS18X20->ROM.Family == OWFAMILY_28) {
+	if (ds18x20HAS_CONF(psDS18X20->ROM.Family)) {
 		PRINT("  Conf=%02X", psDS18X20->fam28.Conf) ;
 	}
-	PRINT("\n") ;
+	PRINT("  Pwr=%s\n", psDS18X20->Parasitic ? "Parasitic" : "External") ;
 }
 
-int32_t	ds18x20SelectAndAddress(ds18x20_t * psDS18X20) {
+/**
+ * ds18x20Xact() - select channel, reset, address the device and execute a function command
+ * @param	Flags	additional owXACT_???? flags (POWER and/or CRC8)
+ * @return	1 if successful (and CRC correct), 0 if no presence or CRC error, erFAILURE
+ */
+int32_t	ds18x20Xact(ds18x20_t * psDS18X20, uint8_t Flags, uint8_t Cmd, uint8_t * pTx, uint8_t TxLen, uint8_t * pRx, uint8_t RxLen) {
 	IF_myASSERT(debugPARAM, INRANGE_SRAM(psDS18X20)) ;
-	int32_t iRV ;
-#if		(halHAS_DS2482_800 == 1)
-	iRV = ds2482ChannelSelect(psDS18X20->Ch) ;
-	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-#endif
-	iRV = OWReset() ;									// check if any device is there
-	IF_myASSERT(debugRESULT, iRV == 1) ;
-
-//	iRV = DS2482SetOverDrive() ;
-//	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
+	ow_rom_t	sROM = psDS18X20->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.pTx = pTx,		.pRx = pRx,
+		.Chan = psDS18X20->Ch,		.Cmd = Cmd,		.TxLen = TxLen,		.RxLen = RxLen,
 #if 	(ds2482SINGLE_DEVICE == 0)
-	memcpy(&sDS2482.ROM, &psDS18X20->ROM, sizeof(ow_rom_t)) ;
-	OWAddress(OW_CMD_MATCHROM) ;						// select the applicable device
+		.Flags = Flags | owXACT_CHAN | owXACT_RESET | owXACT_MATCH,	// select the applicable device
 #else
-	OWAddress(OW_CMD_SKIPROM) ;
+		.Flags = Flags | owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
 #endif
-	return 1 ;
+	} ;
+	return OWXactRun(&sXact) ;
 }
 
 int32_t	ds18x20ReadScratchPad(ds18x20_t * psDS18X20) {
-	int32_t iRV, xCount = 0 ;
+	int32_t iRV ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_SCRATCHPAD, psDS18X20->Ch) ;
 	do {
-		iRV = ds18x20SelectAndAddress(psDS18X20) ;
-		IF_myASSERT(debugRESULT, iRV == 1) ;
-
-		iRV = OWWriteByteWait(DS18X20_READ_SP) ;		// request to read the scratch pad
-		IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
-		memset(psDS18X20->RegX, 0xFF, SIZEOF_MEMBER(ds18x20_t, RegX)) ;	// preset all=0xFF to read
-		OWBlock(psDS18X20->RegX, SIZEOF_MEMBER(ds18x20_t, RegX)) ;		// read the scratch pad
-		iRV = OWCheckCRC(psDS18X20->RegX, SIZEOF_MEMBER(ds18x20_t, RegX)) ;
+		iRV = ds18x20Xact(psDS18X20, owXACT_CRC8, DS18X20_READ_SP, NULL, 0,
+				psDS18X20->RegX, SIZEOF_MEMBER(ds18x20_t, RegX)) ;	// read the scratch pad
 		IF_PRINT(debugRESULT, "SP Read: %-'+b\n", SIZEOF_MEMBER(ds18x20_t, RegX), psDS18X20->RegX) ;
-		if (iRV == 0) {
-			vTaskDelay(pdMS_TO_TICKS(20)) ;
-		}
-	} while (iRV != 1 && ++xCount < ds2482RETRIES) ;
+	} while (iRV != 1 && OWRetryNext(&sRetry)) ;		// backoff delay done by policy
+	ds2482HealthUpdate(psDS18X20->Ch, iRV) ;
 	return iRV ;
 }
 
 int32_t	ds18x20WriteScratchPad(ds18x20_t * psDS18X20) {
-	int32_t iRV = ds18x20SelectAndAddress(psDS18X20) ;
+	uint8_t	Len = ds18x20HAS_CONF(psDS18X20->ROM.Family) ? 3 : 2 ;	// Thi, Tlo [+Conf]
+	int32_t iRV = ds18x20Xact(psDS18X20, 0, DS18X20_WRITE_SP, &psDS18X20->Thi, Len, NULL, 0) ;
 	IF_myASSERT(debugRESULT, iRV == 1) ;
-
-	iRV = OWWriteByteWait(DS18X20_WRITE_SP) ;			// request to write the scratch pad
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
-	OWBlock(&psDS18X20->Thi, psDS18X20->ROM.Family == OWFAMILY_28 ? 3 : 2) ;	// Thi, Tlo [+Conf]
-	IF_PRINT(debugDS18X20, "SP Write: %-'+b\n", psDS18X20->ROM.Family == OWFAMILY_28 ? 3 : 2, &psDS18X20->Thi) ;
-	return 1 ;
+	IF_PRINT(debugDS18X20, "SP Write: %-'+b\n", Len, &psDS18X20->Thi) ;
+	return iRV ;
 }
 
 int32_t	ds18x20CopyScratchPad(ds18x20_t * psDS18X20) {
-	int32_t iRV = ds18x20SelectAndAddress(psDS18X20) ;
-	IF_myASSERT(debugRESULT, iRV == 1) ;
-
-#if		(ds18x20PWR_SOURCE == 0)
-	OWWriteBytePower(DS18X20_COPY_SP) ;					// request to write scratch pad to EE
-	IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 1) ;
+	if (psDS18X20->Parasitic == 0) {
+		IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 0) ;
+		int32_t iRV = ds18x20Xact(psDS18X20, 0, DS18X20_COPY_SP, NULL, 0, NULL, 0) ;
+		IF_myASSERT(debugRESULT, iRV == 1) ;
+		return iRV ;
+	}
+	if (ds2482Lock(psDS18X20->Ch) != erSUCCESS) {		// held till SPU is turned off again
+		return erFAILURE ;
+	}
+	int32_t iRV = ds18x20Xact(psDS18X20, owXACT_POWER, DS18X20_COPY_SP, NULL, 0, NULL, 0) ;	// scratch pad to EE
+	IF_myASSERT(debugRESULT, iRV == 1 && sDS2482.Regs.SPU == 1) ;
 	vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_SP_COPY)) ;	// keep SPU=1 for at least 10mS
 
 	OWLevel(owMODE_STANDARD) ;							// make SPU=0
 	IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 0) ;
-#else
-	IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 0) ;
-	OWWriteByte(DS18X20_COPY_SP) ;
-#endif
-	return 1 ;
+	ds2482Unlock() ;
+	return iRV ;
 }
 
 int32_t	ds18x20ResetConfig(ds18x20_t * psDS18X20) {
@@ -148,60 +154,250 @@ int32_t	ds18x20ResetConfig(ds18x20_t * psDS18X20) {
 	return erSUCCESS ;
 }
 
-int32_t	ds18x20CheckPower(uint8_t Chan) {
-	int32_t	iRV ;
-#if		(halHAS_DS2482_800 == 1)
-	iRV = ds2482ChannelSelect(Chan) ;
-	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+/**
+ * ds18x20CheckPower() - read the power supply type of a single sensor
+ * @brief	A parasitic sensor pulls the bus low during the first read slot, an externally powered
+ * 			one leaves it high. Later slots are undefined so only bit 0 is tested. If the sensor
+ * 			can not be read it is taken to be parasitic (worst case)
+ * @return	1 if parasitic, 0 if externally powered
+ */
+int32_t	ds18x20CheckPower(ds18x20_t * psDS18X20) {
+#if		(ds18x20PWR_SOURCE == 0)
+	return 1 ;
+#elif	(ds18x20PWR_SOURCE == 1 || ds18x20PWR_SOURCE == 2)
+	return 0 ;
+#else
+	uint8_t	Type = 0 ;
+	int32_t iRV = ds18x20Xact(psDS18X20, 0, DS18X20_READ_PSU, NULL, 0, &Type, sizeof(Type)) ;
+	IF_myASSERT(debugRESULT, iRV == 1) ;
+	return (iRV == 1 && (Type & 0x01)) ? 0 : 1 ;		// only the first read slot is defined
 #endif
-	iRV = OWWriteByte(DS18X20_READ_PSU) ;		// request to read Power Supply Type
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
+}
 
+/**
+ * ds18x20ConvTicks() - conversion time of the slowest sensor on a channel
+ * @brief	Parasitic sensors are given the fixed worst case, all others the time their
+ * 			(10 & 22 families default 12 bit) resolution requires
+ */
+static TickType_t	ds18x20ConvTicks(uint8_t Chan) {
+	uint32_t	mSec = 0 ;
+	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+		ds18x20_t * psTemp = psDS18X20 + Idx ;
+		if (psTemp->Ch != Chan) {
+			continue ;
+		}
+		uint32_t Res = ds18x20HAS_CONF(psTemp->ROM.Family) ? psTemp->Res : owFAM28_RES12B ;
+		uint32_t Time = psTemp->Parasitic ? ds18x20DELAY_CONVERT_PARASITIC : ds18x20DELAY_CONVERT_9B << Res ;
+		if (mSec < Time) {
+			mSec = Time ;
+		}
+	}
+	return pdMS_TO_TICKS(mSec) + 1 ;
+}
+
+/**
+ * ds18x20SweepSort() - build the sweep order, sensors grouped by channel (and coupler branch)
+ * @brief	Enumeration is done per family, so sensors on the same channel are not adjacent.
+ * 			Sweeping in channel order means each channel is selected only once per phase.
+ * 			psDS18X20[] itself is not reordered since it is indexed by endpoint number.
+ */
+void	ds18x20SweepSort(void) {
+	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+		uint8_t	Cur = Idx ;
+		int32_t	Pos = Idx ;									// insertion sort, stable & tiny N
+		while (Pos > 0 && ds18x20GROUP(SweepOrder[Pos-1]) > ds18x20GROUP(Cur)) {
+			SweepOrder[Pos] = SweepOrder[Pos-1] ;
+			--Pos ;
+		}
+		SweepOrder[Pos] = Cur ;
+	}
+}
+
+/**
+ * ds18x20SetPeriod() - set the sampling period of a sensor
+ * @param	Idx		endpoint index of the sensor
+ * @param	Secs	period in seconds, 0 = sample on every sweep
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	ds18x20SetPeriod(int32_t Idx, uint16_t Secs) {
+	if (Idx >= Fam10_28Count || Secs > 0x3FFF) {
+		return erFAILURE ;
+	}
+	psDS18X20[Idx].Period	= Secs ;
+	psDS18X20[Idx].NextDue	= xTaskGetTickCount() ;		// sample on the next sweep
 	return erSUCCESS ;
 }
 
+/**
+ * ds18x20MarkDue() - select the sensors whose sample is due
+ * @brief	Sensors due before the conversion started now would complete are included, so that
+ * 			a sensor just short of its deadline does not cost a sweep of its own
+ * @return	number of sensors due
+ */
+int32_t	ds18x20MarkDue(void) {
+	TickType_t	Now = xTaskGetTickCount() ;
+	int32_t	Count = 0 ;
+	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+		ds18x20_t * psTemp = psDS18X20 + Idx ;
+		TickType_t	Slack = ds18x20ConvTicks(psTemp->Ch) ;
+		psTemp->Due = (psTemp->Period == 0 || (int32_t) (Now + Slack - psTemp->NextDue) >= 0) ? 1 : 0 ;
+		Count += psTemp->Due ;
+	}
+	return Count ;
+}
+
+/**
+ * ds18x20Reschedule() - set the next deadline of a sensor just sampled
+ * @brief	Deadlines advance by whole periods to avoid drift, if too far behind restart from now
+ */
+void	ds18x20Reschedule(ds18x20_t * psTemp) {
+	if (psTemp->Period == 0) {
+		return ;
+	}
+	TickType_t	Now = xTaskGetTickCount() ;
+	TickType_t	Period = pdMS_TO_TICKS(psTemp->Period * 1000UL) ;
+	psTemp->NextDue += Period ;
+	if ((int32_t) (psTemp->NextDue - Now) <= 0) {
+		psTemp->NextDue = Now + Period ;
+	}
+}
+
 /**
  * ds18x20TriggerPhase() - Trigger temp conversion on all DS18X20's
- * @param psDS18X20
+ * @brief	Externally powered groups are triggered first, parasitic groups last so that a strong
+ * 			pullup, once armed, is not ended by the triggers still to follow. Completion can only
+ * 			be polled where a single conversion command (Skip ROM group or one sensor) was issued
+ * 			on the channel and no SPU is required.
  */
 void	ds18x20TriggerPhase(void) {
-	// Phase 1: trigger the conversions
+	// Phase 1: trigger the conversions of sensors due, on healthy channels only
+	SweepMask = TrigMask = PowerMask = PollMask = 0 ;
 	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
 		ds18x20_t * psTemp = psDS18X20 + Idx ;
-		int32_t	iRV = ds18x20SelectAndAddress(psTemp) ;
-		IF_myASSERT(debugRESULT, iRV == 1) ;
-
-#if		(ds18x20PWR_SOURCE == 0)
-		OWWriteBytePower(DS18X20_CONVERT) ;				// Trigger temperature conversion & SPU
-		IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 1) ;
-#else
-		OWWriteByte(DS18X20_CONVERT) ;					// Trigger temperature conversion
+		if (psTemp->Due && ds2482HealthUsable(psTemp->Ch)) {
+			SweepMask |= (1 << psTemp->Ch) ;
+		}
+	}
+	for (uint8_t Power = 0; Power < 2; ++Power) {		// external first, then parasitic
+		uint16_t	DoneGroup = 0xFFFF ;
+		for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+			ds18x20_t * psTemp = psDS18X20 + SweepOrder[Idx] ;
+			uint16_t	Group = ds18x20GROUP(SweepOrder[Idx]) ;
+			if (psTemp->Due == 0 || (SweepMask & (1 << psTemp->Ch)) == 0 || Group == DoneGroup) {
+				continue ;
+			}
+			int32_t	DueCount = 0 ;						// sorted, so the group follows
+			uint8_t	GroupPower = 0 ;					// any parasitic sensor converting
+			for (int32_t Next = Idx; Next < Fam10_28Count && ds18x20GROUP(SweepOrder[Next]) == Group; ++Next) {
+				DueCount += psDS18X20[SweepOrder[Next]].Due ;
+				GroupPower |= psDS18X20[SweepOrder[Next]].Parasitic ;
+			}
+			if (DueCount == 1) {
+				GroupPower = psTemp->Parasitic ;		// only this sensor converts
+			}
+			if (GroupPower != Power) {
+				continue ;
+			}
+			const uint8_t Flags = Power ? owXACT_POWER : 0 ;	// & SPU
+			int32_t	iRV ;
+			if (DueCount > 1) {							// batch: one Skip ROM for the group
+#if		(halHAS_DS2409 == 1)
+				ds2409Broadcast(psTemp->Ch, Group & 0xFF) ;	// only this branch, or trunk only
 #endif
+				ow_xact_t	sXact = {
+					.Flags = Flags | owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+					.Chan = psTemp->Ch, .Cmd = DS18X20_CONVERT,
+				} ;
+				iRV = OWXactRun(&sXact) ;
+				DoneGroup = Group ;
+			} else {
+				iRV = ds18x20Xact(psTemp, Flags, DS18X20_CONVERT, NULL, 0, NULL, 0) ;	// Trigger conversion
+			}
+			IF_myASSERT(debugRESULT, iRV == 1) ;
+			uint8_t	Mask = 1 << psTemp->Ch ;
+			if (Power || (TrigMask & Mask)) {			// SPU or an earlier conversion, can not poll
+				PollMask &= ~Mask ;
+			} else {
+				PollMask |= Mask ;
+			}
+			PowerMask	|= Power ? Mask : 0 ;
+			TrigMask	|= Mask ;
+			ConvDue[psTemp->Ch] = xTaskGetTickCount() + ds18x20ConvTicks(psTemp->Ch) ;
+			if (Power == 0 && ds2482ArbYield()) {		// parasitic: SPU held, can not hand over
+				PollMask = 0 ;							// bus may have been reset since, wait till due
+			}
+		}
 	}
 }
 
 /**
- * ds18x20WaitPhase() - Wait the correct period of time for the temperature conversion to complete
- * @brief	Optionally restore to standard power level (SPU=0)
+ * ds18x20WaitPhase() - Wait for the temperature conversions to complete
+ * @brief	With any SPU armed the bus must stay quiet for the parasitic worst case, then SPU is
+ * 			turned off. Otherwise the last sensor addressed on each channel answers read slots
+ * 			with 0 till its conversion is done, channels that can not be polled wait till due.
+ * 			A reset by another user ends those read slots, a poll would then read 1's and the
+ * 			scratchpad be read too early. So while polling the bridge is kept between polls and
+ * 			only handed over if a higher class is waiting, after which all channels wait till due.
+ * 			With nothing left to poll the bridge is released while waiting.
  */
 void	ds18x20WaitPhase(void) {
 	// Phase 2: wait till conversions done and possibly turn off SPU
-#if		(ds18x20PWR_SOURCE == 0)
-	vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_CONVERT_PARASITIC)) ;
-	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
-#if		(halHAS_DS2482_800 == 1)
-		ds18x20_t * psTemp = psDS18X20 + Idx ;
-		int32_t	iRV = ds2482ChannelSelect(psTemp->Ch) ;
-		IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-#endif
-		IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 1) ;
-		OWLevel(owMODE_STANDARD) ;
-		IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 0) ;
+	if (PowerMask) {
+		vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_CONVERT_PARASITIC)) ;
+		for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+			if ((PowerMask & (1 << Chan)) == 0 || ds2482Lock(Chan) != erSUCCESS) {
+				continue ;
+			}
+			OWLevel(owMODE_STANDARD) ;					// SPU=0, only written if still armed
+			IF_myASSERT(debugRESULT, sDS2482.Regs.SPU == 0) ;
+			ds2482Unlock() ;
+		}
+		return ;										// external sensors done long ago
 	}
-#else
-	vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_CONVERT_EXTERNAL)) ;
-	// add optimised code to loop whilst conversion is being done.....
-#endif
+	uint8_t	Todo = TrigMask ;
+	while (Todo) {
+		TickType_t	Now = xTaskGetTickCount() ;
+		for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+			uint8_t	Mask = 1 << Chan ;
+			if ((Todo & Mask) == 0) {
+				continue ;
+			}
+			if ((int32_t) (Now - ConvDue[Chan]) >= 0) {	// slowest resolution, done anyway
+				Todo &= ~Mask ;
+				continue ;
+			}
+			if ((PollMask & Mask) == 0 || ds2482Lock(Chan) != erSUCCESS) {
+				continue ;
+			}
+			int32_t	Byte = ds2482XactReadByte() ;		// 8 read slots, any 1 means done
+			ds2482Unlock() ;
+			if (Byte != 0) {							// done or bus error, read phase will tell
+				Todo &= ~Mask ;
+			}
+		}
+		if (Todo & PollMask) {							// hold the bus, yield only on demand
+			vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_POLL)) ;
+			if (ds2482ArbYield()) {
+				PollMask = 0 ;
+			}
+		} else if (Todo) {
+			ds2482ArbRelease() ;						// bus is free while converting
+			vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_POLL)) ;
+			ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+		}
+	}
+}
+
+/**
+ * ds18x20StoreValue() - convert the scratchpad temperature & store
+ * @return	raw (1/16 degree) value
+ */
+int32_t	ds18x20StoreValue(ds18x20_t * psTemp) {
+	int32_t	iRV = xConvert2sComp((psTemp->Tmsb << 8) | psTemp->Tlsb, 13) ;
+	psTemp->xVal.f32 = (float) iRV / 16 ;
+	IF_PRINT(debugDS18X20, "%02X/%#M/%02X  Raw=%d  Val=%f\n",
+		psTemp->ROM.Family, psTemp->ROM.TagNum, psTemp->ROM.CRC, iRV, psTemp->xVal.f32) ;
+	return iRV ;
 }
 
 /**
@@ -212,30 +408,114 @@ void	ds18x20WaitPhase(void) {
 int32_t	ds18x20ReadPhase(void) {
 	int32_t	iRV  = 0 ;
 	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
-		ds18x20_t * psTemp = psDS18X20 + Idx ;
-		ds18x20ReadScratchPad(psTemp) ;
+		ds18x20_t * psTemp = psDS18X20 + SweepOrder[Idx] ;
+		if (psTemp->Due == 0 || (SweepMask & (1 << psTemp->Ch)) == 0) {
+			continue ;
+		}
+		ds18x20Reschedule(psTemp) ;
+		ds2482ArbYield() ;								// between devices, never mid transaction
+		if (ds18x20ReadScratchPad(psTemp) != 1) {
+			continue ;									// keep last good value
+		}
+		iRV = ds18x20StoreValue(psTemp) ;
+	}
+	return iRV ;
+}
 
-		// convert & store the temperature
-		iRV = xConvert2sComp((psTemp->Tmsb << 8) | psTemp->Tlsb, 13) ;
-		psTemp->xVal.f32 = (float) iRV / 16 ;
-		IF_PRINT(debugDS18X20, "%02X/%#M/%02X  Raw=%d  Val=%f\n",
-			psTemp->ROM.Family, psTemp->ROM.TagNum, psTemp->ROM.CRC, iRV, psTemp->xVal.f32) ;
+#if		(ds18x20PIPELINE == 1)
+#if		(halHAS_DS2409 == 1)
+	#error	"Pipelined sweep broadcasts per channel, not supported with DS2409 couplers"
+#endif
+/* Pipelined sweep, only with external power since a parasitic channel needs the single strong
+ * pullup of the bridge for the whole conversion and channels can then not overlap.
+ * Each channel is converted with one Skip ROM broadcast and is re-triggered as soon as it has
+ * been read, so the conversion for the next sweep runs while the other channels are read and
+ * while the task waits for the next sweep. In steady state (sweep interval > conversion time)
+ * a sweep only costs the reads, at the price of values being up to one sweep interval old. */
+
+static	uint8_t		ConvBusy = 0 ;						// channels with a conversion in progress
+
+static int32_t	ds18x20PipeTrigger(uint8_t Chan) {
+	ow_xact_t	sXact = {
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_SKIP, .Chan = Chan, .Cmd = DS18X20_CONVERT,
+	} ;
+	int32_t	iRV = OWXactRun(&sXact) ;
+	if (iRV == 1) {
+		ConvDue[Chan]	= xTaskGetTickCount() + ds18x20ConvTicks(Chan) ;
+		ConvBusy		|= (1 << Chan) ;
+	} else {
+		ConvBusy		&= ~(1 << Chan) ;
+		ds2482HealthUpdate(Chan, 0) ;
 	}
 	return iRV ;
 }
 
+int32_t	ds18x20PipelineSweep(void) {
+	uint8_t	ChanMask = 0, DueMask = 0 ;
+	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+		if (ds2482HealthUsable(psDS18X20[Idx].Ch)) {
+			ChanMask |= (1 << psDS18X20[Idx].Ch) ;
+			DueMask |= psDS18X20[Idx].Due ? (1 << psDS18X20[Idx].Ch) : 0 ;
+		}
+	}
+	ConvBusy &= ChanMask ;								// forget quarantined channels
+	for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		if ((ChanMask & ~ConvBusy) & (1 << Chan)) {		// first sweep or channel recovered
+			ds18x20PipeTrigger(Chan) ;
+		}
+	}
+
+	uint8_t	Todo = ConvBusy & DueMask ;						// only wait for channels with work
+	while (Todo) {
+		uint8_t	Next = 0xFF ;							// channel due first
+		for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+			if ((Todo & (1 << Chan)) && (Next == 0xFF || (int32_t) (ConvDue[Chan] - ConvDue[Next]) < 0)) {
+				Next = Chan ;
+			}
+		}
+		int32_t	Wait = (int32_t) (ConvDue[Next] - xTaskGetTickCount()) ;
+		if (Wait > 0) {
+			ds2482ArbRelease() ;						// bus is free while converting
+			vTaskDelay(Wait) ;
+			ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+		}
+		for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+			ds18x20_t * psTemp = psDS18X20 + SweepOrder[Idx] ;
+			if (psTemp->Ch != Next || psTemp->Due == 0) {
+				continue ;
+			}
+			ds18x20Reschedule(psTemp) ;
+			ds2482ArbYield() ;
+			if (ds18x20ReadScratchPad(psTemp) == 1) {
+				ds18x20StoreValue(psTemp) ;				// else keep last good value
+			}
+		}
+		ds18x20PipeTrigger(Next) ;						// converts while the others are read
+		Todo &= ~(1 << Next) ;
+	}
+	return erSUCCESS ;
+}
+#endif
+
 /**
- * ds18x20ConvertAndReadAll()
+ * ds18x20Sweep() - convert & read all sensors due, the family driver sweep
  * @brief	To trigger temperature conversion for FAM10 & FAM28 the same command is used.
- * @param	psEpWork
- * @return
+ * @return	erSUCCESS
  */
-int32_t	ds18x20ConvertAndReadAll(ep_work_t * psEpWork) {
-	if (Fam10_28Count) {
+static int32_t	ds18x20Sweep(void * pVoid) {
+	if (Fam10_28Count && ds18x20MarkDue()) {
 		IF_SYSTIMER_START(debugTIMING, systimerDS18X20) ;
+		ds2482STAT_START(Start) ;
+		ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+#if		(ds18x20PIPELINE == 1)
+		ds18x20PipelineSweep() ;
+#else
 		ds18x20TriggerPhase() ;
 		ds18x20WaitPhase() ;
 		ds18x20ReadPhase() ;
+#endif
+		ds2482ArbRelease() ;
+		ds2482STAT_STOP(ds2482OP_SWEEP, Start) ;
 		IF_SYSTIMER_STOP(debugTIMING, systimerDS18X20) ;
 	}
 	return erSUCCESS ;
@@ -244,34 +524,17 @@ int32_t	ds18x20ConvertAndReadAll(ep_work_t * psEpWork) {
 float	ds18x20GetTemperature(int32_t Idx) { return psDS18X20[Idx].xVal.f32 ; }
 
 int32_t	ds18x20AllInOne(void) {
-	int32_t iRV ;
-#if		(halHAS_DS2482_800 == 1)
-	iRV = ds2482ChannelSelect(psDS18X20->Ch) ;
-	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-#endif
-	iRV = OWReset() ;									// check if any device is there
+	uint8_t	Flags = psDS18X20->Parasitic ? owXACT_POWER : 0 ;
+	int32_t iRV = ds18x20Xact(psDS18X20, Flags, DS18X20_CONVERT, NULL, 0, NULL, 0) ;	// Trigger conversion
 	IF_myASSERT(debugRESULT, iRV == 1) ;
-
-	memcpy(&sDS2482.ROM, &psDS18X20->ROM, sizeof(ow_rom_t)) ;
-	OWAddress(OW_CMD_MATCHROM) ;						// select the applicable device
-
-	OWWriteByte(DS18X20_CONVERT) ;						// Trigger temperature conversion
-#if		(ds18x20PWR_SOURCE == 0)
-	vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_CONVERT_PARASITIC)) ;
-#else
-	vTaskDelay(pdMS_TO_TICKS(ds18x20DELAY_CONVERT_EXTERNAL)) ;
-#endif
-	iRV = OWReset() ;									// check if any device is there
+	vTaskDelay(ds18x20ConvTicks(psDS18X20->Ch)) ;
+	if (Flags) {
+		OWLevel(owMODE_STANDARD) ;						// make SPU=0
+	}
+	iRV = ds18x20Xact(psDS18X20, 0, DS18X20_READ_SP, NULL, 0,
+			psDS18X20->RegX, SIZEOF_MEMBER(ds18x20_t, RegX)) ;		// read the scratch pad
 	IF_myASSERT(debugRESULT, iRV == 1) ;
 
-	OWAddress(OW_CMD_MATCHROM) ;						// select the applicable device
-
-	iRV = OWWriteByteWait(DS18X20_READ_SP) ;			// request to read the scratch pad
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
-	memset(psDS18X20->RegX, 0xFF, SIZEOF_MEMBER(ds18x20_t, RegX)) ;	// preset all=0xFF to read
-	OWBlock(psDS18X20->RegX, SIZEOF_MEMBER(ds18x20_t, RegX)) ;		// read the scratch pad
-
 	psDS18X20->xVal.f32 = (float) iRV / 16 ;
 	IF_PRINT(debugDS18X20, "%02X/%#M/%02X  Raw=%d  Val=%f\n",
 		psDS18X20->ROM.Family, psDS18X20->ROM.TagNum, psDS18X20->ROM.CRC, iRV, psDS18X20->xVal.f32) ;
@@ -282,13 +545,20 @@ int32_t	ds18x20AllInOne(void) {
 // #################################################################################################
 
 int32_t	ds18x20HandleEnumerate(int32_t iCount, void * pVoid) {
-	IF_myASSERT(debugPARAM, iCount < Fam10_28Count) ;
+	if (EnumIdx >= Fam10_28Count) {						// added since counted, next Config
+		IF_PRINT(debugTRACK, "Not counted, skipped\n") ;
+		return erSUCCESS ;
+	}
+	iCount = EnumIdx++ ;								// running over all families & scans
 	ep_info_t * psEpInfo = pVoid ;
 	ds18x20_t * psDS18Xtemp = &psDS18X20[iCount] ;
 	// Save the address info of the device just enumerated
 	memcpy(&psDS18Xtemp->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
 	psDS18Xtemp->Ch		= sDS2482.CurChan ;
 	psDS18Xtemp->Idx	= iCount ;
+	psDS18Xtemp->Period	= 0 ;							// default, sample every sweep
+	psDS18Xtemp->NextDue= xTaskGetTickCount() ;
+	psDS18Xtemp->Parasitic = ds18x20CheckPower(psDS18Xtemp) ;	// before Copy SP, it might need SPU
 #if 0
 	ds18x20ReadScratchPad(psDS18Xtemp) ;
 	if (sDS2482.ROM.Family == OWFAMILY_28) {
@@ -313,10 +583,25 @@ int32_t	ds18x20HandleEnumerate(int32_t iCount, void * pVoid) {
 	return erSUCCESS ;
 }
 
+/**
+ * ds18x20HandleEnumerate42() - DS28EA00 found by search after an incomplete chain sequence
+ * @brief	Those already listed in cable order are skipped, the rest are appended
+ */
+static int32_t	ds18x20HandleEnumerate42(int32_t iCount, void * pVoid) {
+	for (int32_t Idx = 0; Idx < EnumIdx; ++Idx) {
+		if (psDS18X20[Idx].ROM.Value == sDS2482.ROM.Value) {
+			return erSUCCESS ;
+		}
+	}
+	return ds18x20HandleEnumerate(iCount, pVoid) ;
+}
+
 int32_t	ds18x20Discover(int32_t xUri) {
 	if (Fam10_28Count) {
 		psDS18X20 = malloc(Fam10_28Count * sizeof(ds18x20_t)) ;
 		IF_myASSERT(debugRESULT, INRANGE_SRAM(psDS18X20)) ;
+		SweepOrder = malloc(Fam10_28Count * sizeof(uint8_t)) ;
+		IF_myASSERT(debugRESULT, INRANGE_SRAM(SweepOrder)) ;
 
 		ep_info_t	sEpInfo ;
 		vEpGetInfoWithIndex(&sEpInfo, xUri) ;			// setup pointers to static and work tables
@@ -327,25 +612,71 @@ int32_t	ds18x20Discover(int32_t xUri) {
 			sEpInfo.pEpWork->Var.varDef.cv.pntr	= 1 ;
 			sEpInfo.pEpWork->Var.varVal.pvoid	= &sDS18X20Func ;
 		}
+		sEpInfo.pEpWork->Var.varDef.cv.varcount = 0 ;	// counted again, Discover can be repeated
 
 		IF_PRINT(debugDS18X20, "AutoEnum DS18X20: ") ;
-		int32_t iRV = ds2482ScanAllChannels(OWFAMILY_10, ds18x20HandleEnumerate, &sEpInfo) ;
-		iRV += ds2482ScanAllChannels(OWFAMILY_28, ds18x20HandleEnumerate, &sEpInfo) ;
+		EnumIdx = 0 ;
+		ds2482ScanAllChannels(OWFAMILY_10, ds18x20HandleEnumerate, &sEpInfo) ;
+		ds2482ScanAllChannels(OWFAMILY_28, ds18x20HandleEnumerate, &sEpInfo) ;
+		ds28ea00ScanChain(ds18x20HandleEnumerate, &sEpInfo) ;	// in cable order
+		if (EnumIdx < Fam10_28Count) {					// chain incomplete (EN/PIOB not wired?)
+			ds2482ScanAllChannels(OWFAMILY_42, ds18x20HandleEnumerate42, &sEpInfo) ;
+		}
 		IF_PRINT(debugDS18X20, "\n") ;
+		if (EnumIdx != Fam10_28Count) {					// sweep only those enumerated, no holes
+			SL_WARN("Only %d/%d enumerated", EnumIdx, Fam10_28Count) ;
+			Fam10_28Count = EnumIdx ;
+		}
+		ds18x20SweepSort() ;
 
 		IF_PRINT(debugTRACK, "Fam10_28 Count=%d\n", Fam10_28Count) ;
 		IF_SYSTIMER_INIT(debugTIMING, systimerDS18X20, systimerTICKS, "DS18X20", myMS_TO_TICKS(10), myMS_TO_TICKS(1000)) ;
-		if (iRV != Fam10_28Count) {
-			SL_ERR("Only %d/%d enumerated!!!", iRV, Fam10_28Count) ;
-			return erFAILURE ;
-		}
 	}
 	return erSUCCESS ;
 }
 
 int32_t	ds18x20Handler(int32_t iCount, void * pVoid) {
-	ds2482PrintROM(&sDS2482.ROM) ;
+	ds2482PrintROM(sDS2482.ROM) ;
 	return erSUCCESS ;
 }
 
+// ################################ Family driver registry support #################################
+
+static int32_t	ds18x20Enumerate(ow_search_t * psS) {
+	++Fam10_28Count ;
+	return 1 ;											// bus power required for conversions
+}
+
+static int32_t	ds18x20DiscoverAll(void) { return ds18x20Discover(URI_DS18X20) ; }
+
+/**
+ * ds18x20ConvertAndReadAll() - endpoint sense hook
+ * @brief	Runs the sweep of every family driver registered, this one included, so DS2450
+ * 			conversions and DS2408 output flushes follow the endpoint timing
+ */
+int32_t	ds18x20ConvertAndReadAll(ep_work_t * psEpWork) { return OWFamilySweep(psEpWork) ; }
+
+static void	ds18x20Teardown(void) {
+	free(psDS18X20) ;
+	free(SweepOrder) ;
+	psDS18X20		= NULL ;
+	SweepOrder		= NULL ;
+	Fam10_28Count	= 0 ;
+}
+
+static ow_family_t	sDS18X20Drv = {
+	.pName		= "DS18X20",
+	.Enumerate	= ds18x20Enumerate,
+	.Discover	= ds18x20DiscoverAll,
+	.Handle		= ds18x20Handler,
+	.Sweep		= ds18x20Sweep,
+	.Teardown	= ds18x20Teardown,
+} ;
+
+void	ds18x20Register(void) {
+	OWFamilyRegister(OWFAMILY_10, &sDS18X20Drv) ;
+	OWFamilyRegister(OWFAMILY_28, &sDS18X20Drv) ;
+	OWFamilyRegister(OWFAMILY_42, &sDS18X20Drv) ;
+}
+
 #endif
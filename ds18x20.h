@@ -33,12 +33,18 @@
 
 // ############################################# Macros ############################################
 
-#define	ds18x20PWR_SOURCE					0			// 0=parasitic, 1=GPIO, 2= External
+#define	ds18x20PWR_SOURCE					3			// 0=parasitic, 1=GPIO, 2= External, 3=Detect per sensor
 #define	ds18x20TRIGGER_GLOBAL				0
 
 #define	ds18x20DELAY_CONVERT_PARASITIC		752
-#define	ds18x20DELAY_CONVERT_EXTERNAL		20
 #define	ds18x20DELAY_SP_COPY				11
+#define	ds18x20DELAY_CONVERT_9B				94			// doubles for each extra bit of resolution
+#define	ds18x20DELAY_POLL					10			// between conversion complete polls
+
+#define	ds18x20PIPELINE						(ds18x20PWR_SOURCE == 1 || ds18x20PWR_SOURCE == 2)	// overlap conversions & reads
+
+// DS18B20 & DS28EA00 have a configuration register with programmable resolution
+#define	ds18x20HAS_CONF(Family)				((Family) == OWFAMILY_28 || (Family) == OWFAMILY_42)
 
 // ######################################## Enumerations ###########################################
 
@@ -61,30 +67,38 @@ typedef struct __attribute__((packed)) {				// DS1820, DS18S20 & DS18B20 9[12] b
 		} ;
 		uint8_t	RegX[9] ;
 	} ;
-	struct {											// Common 1-Wire endpoint enumeration info
+	struct __attribute__((packed)) {					// Common 1-Wire endpoint enumeration info
 		uint8_t		Ch	: 3 ;							// Channel the device was discovered on
 		uint8_t		Idx	: 3 ;							// Endpoint index (0->7) of this specific device
 		uint8_t		Res	: 2 ;							// Resolution 0=9b 1=10b 2=11b 3=12b
-		uint8_t		spare[2] ;
+		uint16_t	Period	: 14 ;						// sampling period in seconds, 0 = every sweep
+		uint16_t	Due		: 1 ;						// selected for the current sweep
+		uint16_t	Parasitic : 1 ;						// powered from the data line, needs SPU
 	} ;
 	x32_t		xVal ;
+	uint32_t	NextDue ;								// tick count when next sample is due
 } ds18x20_t ;
 
 DUMB_STATIC_ASSERT(sizeof(struct fam10) == sizeof(struct fam28)) ;
-DUMB_STATIC_ASSERT(sizeof(ds18x20_t) == 24) ;
+DUMB_STATIC_ASSERT(sizeof(ds18x20_t) == 28) ;
 
 // #################################### Public Data structures #####################################
 
 extern uint8_t Fam10_28Count ;
+extern ds18x20_t * psDS18X20 ;
 
 // ###################################### Private functions ########################################
 
 void	ds18x20EnableExtPSU(ds18x20_t * psDS18X20) ;
 void	ds18x20DisableExtPSU(ds18x20_t * psDS18X20) ;
 int32_t	ds18x20Discover(int32_t xUri)  ;
+int32_t	ds18x20ReadScratchPad(ds18x20_t * psDS18X20) ;
+int32_t	ds18x20CheckPower(ds18x20_t * psDS18X20) ;
 
 float	ds18x20GetTemperature(int32_t Idx) ;
+int32_t	ds18x20SetPeriod(int32_t Idx, uint16_t Secs) ;
 struct ep_work_s ;
 int32_t	ds18x20ConvertAndReadAll(struct ep_work_s *) ;
 int32_t	ds18x20AllInOne(void) ;
 int32_t	ds18x20Handler(int32_t, void *) ;
+void	ds18x20Register(void) ;
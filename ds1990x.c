@@ -24,10 +24,13 @@
 
 #include	"x_config.h"
 
-#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1) && (halHAS_DS1990X == 1)
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS1990X == 1)
 
 #include	"ds1990x.h"
 #include	"ds2482.h"
+#include	"owevents.h"
+#include	"owromidx.h"
+#include	"owfamily.h"
 
 #include	"task_events.h"
 
@@ -55,9 +58,11 @@
 #if		(halHAS_DS2482_800 == 1)
 	ow_rom_t	LastROM[ds2482NUM_CHAN]		= { 0 } ;
 	seconds_t	LastRead[ds2482NUM_CHAN]	= { 0 } ;
-#elif	(halHAS_DS2482_100 == 1 && ESP32_VARIANT == ESP32_VAR_WROVERKIT) // breakout on ESP32-WROVER-KIT or M5FIRE ?
+	uint8_t		Present						= 0 ;		// bitmap of channels with iButton present
+#elif	((halHAS_DS2482_100 == 1 || halHAS_DS2484 == 1) && ESP32_VARIANT == ESP32_VAR_WROVERKIT) // breakout on ESP32-WROVER-KIT or M5FIRE ?
 	ow_rom_t	LastROM		= { 0 } ;
 	seconds_t	LastRead	= 0 ;
+	uint8_t		Present		= 0 ;
 #endif
 uint8_t		Family01Count = 0 ;
 uint8_t		OWdelay	= ds1990READ_INTVL ;
@@ -78,17 +83,31 @@ int32_t	ds1990xHandleRead(int32_t iCount, void * pVoid) {
 		IF_PRINT(debugTRACK, "SAME iButton in 5sec, Skipped...\n") ;
 		return erSUCCESS ;
 	}
+	if ((Present & (1 << Chan)) && (LastROM[Chan].Value != sDS2482.ROM.Value)) {
+		OWEventPost(owEVT_DEPART, sDS2482.CurChan, LastROM[Chan], owACCESS_NONE) ;	// swapped between scans
+	}
+	if ((Present & (1 << Chan)) == 0 || (LastROM[Chan].Value != sDS2482.ROM.Value)) {
+		OWEventPost(owEVT_ARRIVE, sDS2482.CurChan, sDS2482.ROM, OWRomIdxAccess(sDS2482.ROM)) ;
+	}
 	LastROM[Chan].Value = sDS2482.ROM.Value ;
 	LastRead[Chan]		= NowRead ;
+	Present				|= (1 << Chan) ;
 	xTaskNotify(EventsHandle, 1UL << (Chan + se1W_FIRST), eSetBits) ;
 
-#elif	(halHAS_DS2482_100 == 1 && ESP32_VARIANT == ESP32_VAR_WROVERKIT) // breakout on ESP32-WROVER-KIT or M5FIRE ?
+#elif	((halHAS_DS2482_100 == 1 || halHAS_DS2484 == 1) && ESP32_VARIANT == ESP32_VAR_WROVERKIT) // breakout on ESP32-WROVER-KIT or M5FIRE ?
 	if ((LastROM.Value == sDS2482.ROM.Value) && (NowRead - LastRead) <= OWdelay) {
 		IF_PRINT(debugTRACK, "SAME iButton in 5sec, Skipped...\n") ;
 		return erSUCCESS ;
 	}
+	if (Present && (LastROM.Value != sDS2482.ROM.Value)) {
+		OWEventPost(owEVT_DEPART, 0, LastROM, owACCESS_NONE) ;	// swapped between scans
+	}
+	if (Present == 0 || (LastROM.Value != sDS2482.ROM.Value)) {
+		OWEventPost(owEVT_ARRIVE, 0, sDS2482.ROM, OWRomIdxAccess(sDS2482.ROM)) ;
+	}
 	LastROM.Value	= sDS2482.ROM.Value ;
 	LastRead		= NowRead ;
+	Present			= 1 ;
 	xTaskNotify(EventsHandle, 1UL << se1W_FIRST, eSetBits) ;
 
 #else
@@ -96,10 +115,36 @@ int32_t	ds1990xHandleRead(int32_t iCount, void * pVoid) {
 #endif
 	portYIELD() ;
 	IF_PRINT(debugTRACK, "NEW iButton Read, or >5sec passed\n") ;
-	IF_EXEC_1(debugTRACK, ds2482PrintROM, &sDS2482.ROM) ;
+	IF_EXEC_1(debugTRACK, ds2482PrintROM, sDS2482.ROM) ;
 	return erSUCCESS ;
 }
 
+/**
+ * ds1990xHandleDepart() - called after a clean family 01 scan of a channel found no iButton
+ * @brief	Posts a single DEPART event (with the last ROM read) if a button was present
+ * @param	PhyChan		physical channel number just scanned
+ */
+void	ds1990xHandleDepart(uint8_t PhyChan) {
+#if		(halHAS_DS2482_800 == 1)
+	#if		(ESP32_VARIANT == ESP32_VAR_AC00)
+	uint8_t	Chan = OWremapTable[PhyChan] ;
+	#elif	(ESP32_VARIANT == ESP32_VAR_AC01)
+	uint8_t	Chan = PhyChan ;
+	#endif
+	if (Present & (1 << Chan)) {
+		Present &= ~(1 << Chan) ;
+		OWEventPost(owEVT_DEPART, PhyChan, LastROM[Chan], owACCESS_NONE) ;
+		xTaskNotify(EventsHandle, 1UL << (Chan + se1W_FIRST), eSetBits) ;
+	}
+#elif	((halHAS_DS2482_100 == 1 || halHAS_DS2484 == 1) && ESP32_VARIANT == ESP32_VAR_WROVERKIT)
+	if (Present) {
+		Present = 0 ;
+		OWEventPost(owEVT_DEPART, 0, LastROM, owACCESS_NONE) ;
+		xTaskNotify(EventsHandle, 1UL << se1W_FIRST, eSetBits) ;
+	}
+#endif
+}
+
 // ################### Identification, Diagnostics & Configuration functions #######################
 
 int32_t	ds1990xDiscover(void) {
@@ -110,4 +155,21 @@ int32_t	ds1990xDiscover(void) {
 	return erSUCCESS ;
 }
 
+static int32_t	ds1990xEnumerate(ow_search_t * psS) {
+	++Family01Count ;									// count ONLY for sake of reporting
+	return 0 ;
+}
+
+static void	ds1990xTeardown(void) { Family01Count = 0 ; }
+
+static ow_family_t	sDS1990xDrv = {
+	.pName		= "DS1990X",
+	.Enumerate	= ds1990xEnumerate,
+	.Discover	= ds1990xDiscover,
+	.Handle		= ds1990xHandleRead,
+	.Teardown	= ds1990xTeardown,
+} ;
+
+void	ds1990xRegister(void) { OWFamilyRegister(OWFAMILY_01, &sDS1990xDrv) ; }
+
 #endif
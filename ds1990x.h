@@ -43,4 +43,6 @@ extern	uint8_t	Family01Count ;
 // ###################################### Private functions ########################################
 
 int32_t	ds1990xHandleRead(int32_t, void *) ;
+void	ds1990xHandleDepart(uint8_t PhyChan) ;
 int32_t	ds1990xDiscover(void) ;
+void	ds1990xRegister(void) ;
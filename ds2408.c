@@ -0,0 +1,371 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2408.c - DS2408 (8 channel) & DS2413 (2 channel) addressable switches
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS2408 == 1)
+
+#include	"ds2408.h"
+#include	"ds2482.h"
+#include	"ds2482arb.h"
+#include	"ds2482health.h"
+#include	"owfamily.h"
+#include	"owxact.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdlib.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Both devices stay in PIO access mode until the next reset, so one addressed session (reset,
+ * Match ROM, command) is followed by as many samples or writes as required:
+ * - DS2408 read returns 1 pin sample per byte plus the inverted CRC16 after every 32 samples,
+ *   the first CRC includes the command byte,
+ * - DS2413 read returns [~PIOB latch, ~PIOB pin, ~PIOA latch, ~PIOA pin, PIOB latch, PIOB pin,
+ *   PIOA latch, PIOA pin] per byte, the complement nibble is the check,
+ * - writes are value, ~value then 0xAA and the new pin state are read back.
+ * Outputs follow the pca9555 interface the actuators dispatch to: pins are numbered flat over
+ * all devices in enumeration order (8 per DS2408, 2 per DS2413), the wanted state is set per
+ * pin and one WriteAll call, from the actuator flush or the family sweep, writes every changed
+ * device in its own verified session. */
+
+ds2408_t *	psDS2408		= NULL ;
+uint8_t		Fam29_3ACount	= 0 ;
+static	uint8_t	EnumIdx		= 0 ;
+
+// ####################################### Local functions #########################################
+
+static int32_t	ds2408Session(ds2408_t * psDS2408, uint8_t Cmd) {
+	ow_rom_t	sROM = psDS2408->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.Chan = psDS2408->Ch,	.Cmd = Cmd,
+#if 	(ds2482SINGLE_DEVICE == 0)
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+#else
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+#endif
+	} ;
+	return OWXactRun(&sXact) ;
+}
+
+// ################################### Global/public functions #####################################
+
+/**
+ * ds2408Stream() - read PIO pin samples continuously in a single addressed session
+ * @param	pBuf	receives the samples, DS2413 samples are the validated low nibble
+ * @return	number of samples read, 0 if no presence, erFAILURE on bus/CRC/check failure
+ */
+int32_t	ds2408Stream(ds2408_t * psDS2408, uint8_t * pBuf, int32_t Count) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psDS2408) && INRANGE_SRAM(pBuf) && Count <= ds2408STREAM_MAX) ;
+	ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+	if (ds2482Lock(psDS2408->Ch) != erSUCCESS) {		// held between the session & the samples
+		ds2482ArbRelease() ;
+		return erFAILURE ;
+	}
+	int32_t	iRV = ds2408Session(psDS2408, DS2408_PIO_READ) ;
+	int32_t	Done = 0 ;
+	uint8_t	Cmd = DS2408_PIO_READ ;
+	uint16_t crc16 = OWCalcCRC16(0, &Cmd, sizeof(Cmd)) ;
+	while (iRV == 1 && Done < Count) {
+		int32_t	Sample = ds2482XactReadByte() ;
+		if (Sample < 0) {
+			iRV = erFAILURE ;
+			break ;
+		}
+		if (psDS2408->ROM.Family == OWFAMILY_3A) {
+			if ((Sample & 0x0F) != (~Sample >> 4 & 0x0F)) {
+				iRV = erFAILURE ;
+				break ;
+			}
+			pBuf[Done++] = Sample & 0x0F ;
+			continue ;
+		}
+		pBuf[Done++] = Sample ;
+		crc16 = OWCalcCRC16(crc16, &pBuf[Done - 1], 1) ;
+		if ((Done % DS2408_CRC_BLOCK) == 0) {			// inverted CRC16, LSB first
+			int32_t	Lsb = ds2482XactReadByte() ;
+			int32_t	Msb = ds2482XactReadByte() ;
+			if (Lsb < 0 || Msb < 0 || (crc16 ^ 0xFFFF) != ((Msb << 8) | Lsb)) {
+				Done -= DS2408_CRC_BLOCK ;				// discard the failed block
+				iRV = erFAILURE ;
+				break ;
+			}
+			crc16 = 0 ;									// next block excludes the command
+		}
+	}
+	ds2482Unlock() ;
+	ds2482ArbRelease() ;
+	ds2482HealthUpdate(psDS2408->Ch, iRV == 1) ;
+	if (Done) {
+		psDS2408->PioIn = pBuf[Done - 1] ;
+	}
+	IF_SL_ERR(iRV == erFAILURE, "PIO read failed after %d", Done) ;
+	return (iRV == 1) ? Done : iRV ;
+}
+
+/**
+ * ds2408Write() - write successive output latch values in a single addressed session
+ * @brief	Each value is confirmed (0xAA) and verified against the pin state read back: a DS2408
+ * 			output latched low must read low, a DS2413 must report the latches written
+ * @return	number of values written, 0 if no presence, erFAILURE on bus/confirm/verify failure
+ */
+int32_t	ds2408Write(ds2408_t * psDS2408, const uint8_t * pVal, int32_t Count) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psDS2408) && Count > 0) ;
+	ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+	if (ds2482Lock(psDS2408->Ch) != erSUCCESS) {
+		ds2482ArbRelease() ;
+		return erFAILURE ;
+	}
+	int32_t	iRV = ds2408Session(psDS2408, DS2408_PIO_WRITE) ;
+	int32_t	Done = 0 ;
+	while (iRV == 1 && Done < Count) {
+		uint8_t	Val = (psDS2408->ROM.Family == OWFAMILY_3A) ? (0xFC | pVal[Done]) : pVal[Done] ;
+		int32_t	Ack = erFAILURE, State = erFAILURE ;
+		if (ds2482XactWriteByte(Val) == erSUCCESS && ds2482XactWriteByte(~Val) == erSUCCESS) {
+			Ack = ds2482XactReadByte() ;
+			State = ds2482XactReadByte() ;
+		}
+		if (Ack != DS2408_PIO_ACK || State < 0) {
+			iRV = erFAILURE ;
+			break ;
+		}
+		if (psDS2408->ROM.Family == OWFAMILY_3A) {		// latches in bits 1 & 3
+			if ((((State >> 1) & 1) | ((State >> 2) & 2)) != (Val & 0x03)) {
+				iRV = erFAILURE ;
+				break ;
+			}
+		} else if (State & ~Val) {						// driven low but reads high
+			iRV = erFAILURE ;
+			break ;
+		}
+		psDS2408->PioOut = Val & ((psDS2408->ROM.Family == OWFAMILY_3A) ? 0x03 : 0xFF) ;
+		++Done ;
+	}
+	ds2482Unlock() ;
+	ds2482ArbRelease() ;
+	ds2482HealthUpdate(psDS2408->Ch, iRV == 1) ;
+	IF_SL_ERR(iRV == erFAILURE, "PIO write failed after %d", Done) ;
+	return (iRV == 1) ? Done : iRV ;
+}
+
+/**
+ * ds2408ReadLatch() - read the DS2408 output latch state register
+ * @brief	Read PIO Registers from the latch register to the end of the control space, the
+ * 			inverted CRC16 follows and covers command, address & data. A DS2413 reports its
+ * 			latches with every PIO sample so ds2408Stream() is used instead.
+ * @return	1 if PioOut & PioNew updated, 0 if no presence, erFAILURE on bus/CRC failure
+ */
+int32_t	ds2408ReadLatch(ds2408_t * psDS2408) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psDS2408)) ;
+	if (psDS2408->ROM.Family == OWFAMILY_3A) {
+		uint8_t	Sample ;
+		int32_t	iRV = ds2408Stream(psDS2408, &Sample, 1) ;
+		if (iRV == 1) {									// latches in bits 1 & 3
+			psDS2408->PioOut = psDS2408->PioNew = ((Sample >> 1) & 1) | ((Sample >> 2) & 2) ;
+		}
+		return iRV ;
+	}
+	uint8_t	Tx[3] = { DS2408_READ_REG, DS2408_REG_LATCH & 0xFF, DS2408_REG_LATCH >> 8 } ;
+	uint8_t	Rx[DS2408_REG_END - DS2408_REG_LATCH + 1 + 2] ;	// registers + CRC16
+	ow_rom_t	sROM = psDS2408->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.Chan = psDS2408->Ch,	.Cmd = Tx[0],
+		.pTx = &Tx[1],	.TxLen = 2,	.pRx = Rx,	.RxLen = sizeof(Rx),
+#if 	(ds2482SINGLE_DEVICE == 0)
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+#else
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+#endif
+	} ;
+	ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+	int32_t	iRV = OWXactRun(&sXact) ;
+	ds2482ArbRelease() ;
+	if (iRV == 1) {
+		uint16_t crc16 = OWCalcCRC16(OWCalcCRC16(0, Tx, sizeof(Tx)), Rx, sizeof(Rx) - 2) ;
+		if ((crc16 ^ 0xFFFF) != ((Rx[sizeof(Rx) - 1] << 8) | Rx[sizeof(Rx) - 2])) {
+			iRV = erFAILURE ;
+		} else {
+			psDS2408->PioOut = psDS2408->PioNew = Rx[0] ;
+		}
+	}
+	ds2482HealthUpdate(psDS2408->Ch, iRV == 1) ;
+	IF_SL_ERR(iRV == erFAILURE, "PIO latch read failed") ;
+	return iRV ;
+}
+
+// ################################ Actuator layer (pca9555 style) #################################
+
+/**
+ * ds2408PinMap() - locate a flat (actuator) pin number
+ * @return	device holding the pin, with *pBit its PIO number, NULL if out of range
+ */
+static ds2408_t *	ds2408PinMap(uint8_t Pin, uint8_t * pBit) {
+	for (int32_t Idx = 0; Idx < Fam29_3ACount; ++Idx) {
+		uint8_t	Pins = ds2408PINS(psDS2408[Idx].ROM.Family) ;
+		if (Pin < Pins) {
+			*pBit = Pin ;
+			return &psDS2408[Idx] ;
+		}
+		Pin -= Pins ;
+	}
+	return NULL ;
+}
+
+uint8_t	ds2408DIG_OUT_Count(void) {
+	uint8_t	Count = 0 ;
+	for (int32_t Idx = 0; Idx < Fam29_3ACount; ++Idx) {
+		Count += ds2408PINS(psDS2408[Idx].ROM.Family) ;
+	}
+	return Count ;
+}
+
+void	ds2408DIG_OUT_SetState(uint8_t Pin, uint8_t State) {
+	uint8_t	Bit ;
+	ds2408_t * psSwitch = ds2408PinMap(Pin, &Bit) ;
+	IF_myASSERT(debugPARAM, psSwitch != NULL) ;
+	if (psSwitch == NULL) {
+		return ;
+	}
+	if (State) {
+		psSwitch->PioNew |= (1 << Bit) ;
+	} else {
+		psSwitch->PioNew &= ~(1 << Bit) ;
+	}
+}
+
+uint8_t	ds2408DIG_OUT_GetState(uint8_t Pin) {
+	uint8_t	Bit ;
+	ds2408_t * psSwitch = ds2408PinMap(Pin, &Bit) ;
+	IF_myASSERT(debugPARAM, psSwitch != NULL) ;
+	return psSwitch ? (psSwitch->PioNew >> Bit) & 1 : 0 ;
+}
+
+/**
+ * ds2408DIG_OUT_WriteAll() - flush the wanted output state of every changed device
+ * @return	erSUCCESS or erFAILURE if any device failed, it is retried on the next call
+ */
+int32_t	ds2408DIG_OUT_WriteAll(void) {
+	int32_t	iRV = erSUCCESS ;
+	for (int32_t Idx = 0; Idx < Fam29_3ACount; ++Idx) {
+		ds2408_t * psSwitch = &psDS2408[Idx] ;
+		if (psSwitch->PioNew != psSwitch->PioOut && ds2408Write(psSwitch, &psSwitch->PioNew, 1) != 1) {
+			iRV = erFAILURE ;
+		}
+	}
+	return iRV ;
+}
+
+int32_t	ds2408DIG_IN_GetState(uint8_t Pin) {
+	uint8_t	Bit ;
+	ds2408_t * psSwitch = ds2408PinMap(Pin, &Bit) ;
+	IF_myASSERT(debugPARAM, psSwitch != NULL) ;
+	if (psSwitch == NULL) {
+		return erFAILURE ;
+	}
+	if (psSwitch->ROM.Family == OWFAMILY_3A) {			// pin states in bits 0 & 2
+		return ((psSwitch->PioIn >> (Bit * 2)) & 1) ;
+	}
+	return (psSwitch->PioIn >> Bit) & 1 ;
+}
+
+// ################################ Family driver registry support #################################
+
+static int32_t	ds2408HandleEnumerate(int32_t iCount, void * pVoid) {
+	ds2408_t * psSwitch = &psDS2408[EnumIdx] ;
+	memcpy(&psSwitch->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
+	psSwitch->Ch	= sDS2482.CurChan ;
+	psSwitch->Idx	= EnumIdx++ ;
+	psSwitch->PioOut = psSwitch->PioNew = (1 << ds2408PINS(psSwitch->ROM.Family)) - 1 ;	// power-on default
+	ds2408ReadLatch(psSwitch) ;							// outputs kept as they are, no glitch
+	IF_EXEC_1(debugTRACK, ds2482PrintROM, psSwitch->ROM) ;
+	return erSUCCESS ;
+}
+
+static int32_t	ds2408Enumerate(ow_search_t * psS) {
+	++Fam29_3ACount ;
+	return 0 ;
+}
+
+static int32_t	ds2408Discover(void) {
+	if (Fam29_3ACount == 0) {
+		return erSUCCESS ;
+	}
+	psDS2408 = malloc(Fam29_3ACount * sizeof(ds2408_t)) ;
+	IF_myASSERT(debugRESULT, INRANGE_SRAM(psDS2408)) ;
+	memset(psDS2408, 0, Fam29_3ACount * sizeof(ds2408_t)) ;
+	EnumIdx = 0 ;
+	int32_t	iRV = ds2482ScanAllChannels(OWFAMILY_29, ds2408HandleEnumerate, NULL) ;
+	iRV += ds2482ScanAllChannels(OWFAMILY_3A, ds2408HandleEnumerate, NULL) ;
+	IF_PRINT(debugTRACK, "Fam29_3A Count=%d\n", Fam29_3ACount) ;
+	if (iRV != Fam29_3ACount) {
+		SL_ERR("Only %d/%d enumerated!!!", iRV, Fam29_3ACount) ;
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static int32_t	ds2408Sweep(void * pVoid) {
+	ds2482ArbAcquire(ds2482PRIO_SENSOR) ;				// device sessions below nest
+	int32_t	iRV = ds2408DIG_OUT_WriteAll() ;
+	for (int32_t Idx = 0; Idx < Fam29_3ACount; ++Idx) {
+		uint8_t	Sample ;
+		ds2482ArbYield() ;
+		if (ds2482HealthUsable(psDS2408[Idx].Ch) && ds2408Stream(&psDS2408[Idx], &Sample, 1) != 1) {
+			iRV = erFAILURE ;
+		}
+	}
+	ds2482ArbRelease() ;
+	return iRV ;
+}
+
+static void	ds2408Teardown(void) {
+	free(psDS2408) ;
+	psDS2408		= NULL ;
+	Fam29_3ACount	= 0 ;
+}
+
+static ow_family_t	sDS2408Drv = {
+	.pName		= "DS2408",
+	.Enumerate	= ds2408Enumerate,
+	.Discover	= ds2408Discover,
+	.Sweep		= ds2408Sweep,
+	.Teardown	= ds2408Teardown,
+} ;
+
+void	ds2408Register(void) {
+	OWFamilyRegister(OWFAMILY_29, &sDS2408Drv) ;
+	OWFamilyRegister(OWFAMILY_3A, &sDS2408Drv) ;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2408.h - DS2408 (8 channel) & DS2413 (2 channel) addressable switches
+ */
+
+#pragma		once
+
+#include	"x_definitions.h"
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2408STREAM_MAX					256			// samples per ds2408Stream() session
+#define	ds2408PINS(Family)					((Family) == OWFAMILY_3A ? 2 : 8)	// PIO's per device
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {				// DS2408 / DS2413 PIO switch
+	ow_rom_t	ROM ;
+	uint8_t		Ch		: 3 ;							// Channel the device was discovered on
+	uint8_t		Idx		: 5 ;							// index in psDS2408[]
+	uint8_t		PioIn ;									// last pin sample
+	uint8_t		PioOut ;								// output latches, read at enumeration or confirmed
+	uint8_t		PioNew ;								// output latches wanted, see ds2408DIG_OUT_WriteAll()
+} ds2408_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ds2408_t) == 12) ;
+
+// #################################### Public Data structures #####################################
+
+extern uint8_t Fam29_3ACount ;
+extern ds2408_t * psDS2408 ;
+
+// ###################################### Private functions ########################################
+
+int32_t	ds2408Stream(ds2408_t * psDS2408, uint8_t * pBuf, int32_t Count) ;
+int32_t	ds2408Write(ds2408_t * psDS2408, const uint8_t * pVal, int32_t Count) ;
+int32_t	ds2408ReadLatch(ds2408_t * psDS2408) ;
+uint8_t	ds2408DIG_OUT_Count(void) ;
+void	ds2408DIG_OUT_SetState(uint8_t Pin, uint8_t State) ;
+uint8_t	ds2408DIG_OUT_GetState(uint8_t Pin) ;
+int32_t	ds2408DIG_OUT_WriteAll(void) ;
+int32_t	ds2408DIG_IN_GetState(uint8_t Pin) ;
+void	ds2408Register(void) ;
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2409.c - DS2409 MicroLAN coupler, main & auxiliary branches as sub-buses
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS2409 == 1)
+
+#include	"ds2409.h"
+#include	"ds2482.h"
+#include	"owfamily.h"
+#include	"owxact.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* The trunk (channel) is always connected, a branch only after a Smart-On of its coupler, and
+ * at most one branch per channel is kept on so branches never merge. The branch switched on is
+ * cached per channel, OWXactRun() calls ds2409Select() for every Match ROM and the coupler is
+ * only commanded if the device is on another branch. Skip ROM reaches the trunk and the branch
+ * currently on, callers broadcast per ds2409GROUP() after ds2409Broadcast() isolated the group.
+ * Enumeration: trunk search with all branches off, then each branch of every coupler found,
+ * devices not seen before are on that branch. Routes are only kept for channels with couplers.
+ * Couplers behind couplers are listed but their branches are not explored. */
+
+static	ds2409_t		sDS2409[ds2409COUPLER_MAX] ;
+static	ds2409_route_t	sRoute[ds2409ROUTE_MAX] ;
+static	uint8_t			Fam1FCount	= 0 ;
+static	uint8_t			RouteCount	= 0 ;
+static	uint8_t			CouplerMask	= 0 ;				// channels with couplers
+static	uint8_t			Active[ds2482NUM_CHAN] ;		// branch on, per channel
+static	uint32_t		Switches	= 0 ;
+
+// ####################################### Local functions #########################################
+
+static int32_t	ds2409Find(ow_rom_t ROM) {
+	for (int32_t Idx = 0; Idx < RouteCount; ++Idx) {
+		if (sRoute[Idx].ROM.Value == ROM.Value) {
+			return Idx ;
+		}
+	}
+	return erFAILURE ;
+}
+
+/**
+ * ds2409Command() - address a coupler and issue a switch command
+ * @brief	The last byte read is the command echoed as confirmation, Smart-On is preceded by the
+ * 			reset stimulus byte that reports the presence on the branch
+ */
+static int32_t	ds2409Command(ds2409_t * psCoupler, uint8_t Cmd, uint8_t RxLen) {
+	uint8_t	Rx[2] ;
+	ow_rom_t	sROM = psCoupler->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.pRx = Rx,	.Chan = psCoupler->Ch,	.Cmd = Cmd,	.RxLen = RxLen,
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+	} ;
+	int32_t	iRV = OWXactRun(&sXact) ;
+	return (iRV == 1 && Rx[RxLen - 1] != Cmd) ? 0 : iRV ;
+}
+
+// ################################### Global/public functions #####################################
+
+uint8_t	ds2409Route(ow_rom_t ROM) {
+	int32_t	Idx = ds2409Find(ROM) ;
+	return (Idx < 0) ? ds2409TRUNK : sRoute[Idx].Branch ;
+}
+
+/**
+ * ds2409AllOff() - switch off the branches of all couplers on a channel
+ * @brief	Skip ROM broadcast, elided if nothing is known to be on
+ */
+int32_t	ds2409AllOff(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	if (Active[Chan] == ds2409TRUNK) {
+		return erSUCCESS ;
+	}
+	uint8_t	Ack ;
+	ow_xact_t	sXact = {
+		.pRx = &Ack,	.Chan = Chan,	.Cmd = DS2409_ALL_OFF,	.RxLen = sizeof(Ack),
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+	} ;
+	int32_t	iRV = OWXactRun(&sXact) ;
+	if (iRV == 1 && ((CouplerMask & (1 << Chan)) == 0 || Ack == DS2409_ALL_OFF)) {
+		Active[Chan] = ds2409TRUNK ;					// no coupler answers 0xFF
+		++Switches ;
+		return erSUCCESS ;
+	}
+	Active[Chan] = ds2409UNKNOWN ;
+	return erFAILURE ;
+}
+
+/**
+ * ds2409Select() - make sure the branch of a device is connected
+ * @param	Branch		ds2409TRUNK (always connected) or ds2409BRANCH()
+ * @return	erSUCCESS or erFAILURE, in which case the coupler state is re-established next time
+ */
+int32_t	ds2409Select(uint8_t Chan, uint8_t Branch) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	if (Branch == ds2409TRUNK || Branch == Active[Chan]) {
+		return erSUCCESS ;
+	}
+	uint8_t	Coupler = (Branch - 1) >> 1 ;
+	IF_myASSERT(debugPARAM, Coupler < Fam1FCount && sDS2409[Coupler].Ch == Chan) ;
+	if (Active[Chan] != ds2409TRUNK && ((Active[Chan] - 1) >> 1) != Coupler &&
+		ds2409AllOff(Chan) != erSUCCESS) {				// other (or unknown) coupler on
+		return erFAILURE ;
+	}
+	int32_t	iRV = ds2409Command(&sDS2409[Coupler], ((Branch - 1) & 1) ? DS2409_SMART_AUX : DS2409_SMART_MAIN, 2) ;
+	Active[Chan] = (iRV == 1) ? Branch : ds2409UNKNOWN ;
+	++Switches ;
+	IF_SL_ERR(iRV != 1, "Ch%d branch %d switch failed", Chan, Branch) ;
+	return (iRV == 1) ? erSUCCESS : erFAILURE ;
+}
+
+/**
+ * ds2409Broadcast() - connect exactly one ds2409GROUP() ahead of a Skip ROM
+ * @brief	For the trunk every branch is switched off, else the branch is selected
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	ds2409Broadcast(uint8_t Chan, uint8_t Branch) {
+	return (Branch == ds2409TRUNK) ? ds2409AllOff(Chan) : ds2409Select(Chan, Branch) ;
+}
+
+void	ds2409Learn(ow_rom_t ROM, uint8_t Chan, uint8_t Branch) {
+	if (ds2409Find(ROM) >= 0) {
+		return ;
+	}
+	if (RouteCount == ds2409ROUTE_MAX) {
+		SL_ERR("Route table full") ;
+		return ;
+	}
+	sRoute[RouteCount].ROM.Value = ROM.Value ;
+	sRoute[RouteCount].Ch		= Chan ;
+	sRoute[RouteCount].Branch	= Branch ;
+	++RouteCount ;
+}
+
+/**
+ * ds2409Wanted() - scan filter, TRUE if the device found belongs to the pass in progress
+ * @brief	With all branches off everything visible is on the trunk, with a branch on only the
+ * 			devices routed there (or new ones) are handled, the trunk ones have been already
+ */
+int32_t	ds2409Wanted(ow_rom_t ROM, uint8_t Chan) {
+	if ((CouplerMask & (1 << Chan)) == 0) {
+		return 1 ;
+	}
+	int32_t	Idx = ds2409Find(ROM) ;
+	if (Idx < 0) {
+		ds2409Learn(ROM, Chan, Active[Chan]) ;
+		return 1 ;
+	}
+	return (Active[Chan] == ds2409TRUNK || sRoute[Idx].Branch == Active[Chan]) ? 1 : 0 ;
+}
+
+/**
+ * ds2409EnumerateBranches() - find the devices behind the couplers on a channel
+ * @brief	Called after the trunk search (with all branches off) of the channel, during which
+ * 			all devices were learnt as trunk devices. Routes of channels without couplers are
+ * 			dropped again.
+ * @return	number of devices found on branches, each passed to OWFamilyEnumerate()
+ */
+int32_t	ds2409EnumerateBranches(uint8_t Chan) {
+	int32_t	iCount = 0 ;
+	for (int32_t Coupler = 0; Coupler < Fam1FCount; ++Coupler) {
+		if (sDS2409[Coupler].Ch != Chan || ds2409Route(sDS2409[Coupler].ROM) != ds2409TRUNK) {
+			continue ;
+		}
+		CouplerMask |= (1 << Chan) ;
+		for (int32_t Aux = 0; Aux < 2; ++Aux) {
+			uint8_t	Branch = ds2409BRANCH(Coupler, Aux) ;
+			if (ds2409Select(Chan, Branch) != erSUCCESS) {
+				continue ;
+			}
+			ow_search_t	sS ;
+			OWSearchInit(&sS, Chan, 0) ;
+			while (ds2482OWSearchNext(&sS) == 1) {
+				if (ds2409Find(sS.ROM) >= 0) {
+					continue ;							// trunk or earlier branch
+				}
+				ds2409Learn(sS.ROM, Chan, Branch) ;
+				OWFamilyEnumerate(&sS) ;
+				++iCount ;
+				IF_EXEC_1(debugTRACK, ds2482PrintROM, sS.ROM) ;
+			}
+		}
+	}
+	if (CouplerMask & (1 << Chan)) {
+		ds2409AllOff(Chan) ;
+		return iCount ;
+	}
+	int32_t	Keep = 0 ;
+	for (int32_t Idx = 0; Idx < RouteCount; ++Idx) {	// no couplers, drop the channel
+		if (sRoute[Idx].Ch != Chan) {
+			sRoute[Keep++] = sRoute[Idx] ;
+		}
+	}
+	RouteCount = Keep ;
+	return iCount ;
+}
+
+/**
+ * ds2409ScanBranches() - ds2482ScanChannel() every branch of the couplers on a channel
+ * @brief	Called after the trunk pass, the channel is left with the last branch on
+ * @return	number of matching devices handled on the branches, or error from a handler
+ */
+int32_t	ds2409ScanBranches(uint8_t Chan, uint8_t Family, int (* Handler)(int32_t, void *), int32_t xCount, void * pVoid) {
+	int32_t	iCount = 0 ;
+	if ((CouplerMask & (1 << Chan)) == 0) {
+		return iCount ;
+	}
+	for (int32_t Coupler = 0; Coupler < Fam1FCount; ++Coupler) {
+		if (sDS2409[Coupler].Ch != Chan || ds2409Route(sDS2409[Coupler].ROM) != ds2409TRUNK) {
+			continue ;
+		}
+		for (int32_t Aux = 0; Aux < 2; ++Aux) {
+			if (ds2409Select(Chan, ds2409BRANCH(Coupler, Aux)) != erSUCCESS) {
+				continue ;
+			}
+			int32_t	iRV = ds2482ScanChannel(Family, Handler, xCount + iCount, pVoid) ;
+			LT_RETURN(iRV, erSUCCESS) ;
+			iCount += iRV ;
+		}
+	}
+	return iCount ;
+}
+
+void	ds2409Report(void) {
+	for (int32_t Coupler = 0; Coupler < Fam1FCount; ++Coupler) {
+		int32_t	Main = 0, Aux = 0 ;
+		for (int32_t Idx = 0; Idx < RouteCount; ++Idx) {
+			Main += (sRoute[Idx].Branch == ds2409BRANCH(Coupler, 0)) ;
+			Aux += (sRoute[Idx].Branch == ds2409BRANCH(Coupler, 1)) ;
+		}
+		PRINT("Ch%d %#M  Main=%d  Aux=%d\n", sDS2409[Coupler].Ch, sDS2409[Coupler].ROM.TagNum, Main, Aux) ;
+	}
+	PRINT("Routes=%u/%u  Switches=%u\n", RouteCount, ds2409ROUTE_MAX, Switches) ;
+}
+
+// ################################ Family driver registry support #################################
+
+static int32_t	ds2409Enumerate(ow_search_t * psS) {
+	if (Fam1FCount == ds2409COUPLER_MAX) {
+		SL_ERR("Too many couplers") ;
+		return 0 ;
+	}
+	memcpy(&sDS2409[Fam1FCount].ROM, &psS->ROM, sizeof(ow_rom_t)) ;
+	sDS2409[Fam1FCount].Ch = psS->Chan ;
+	++Fam1FCount ;
+	return 0 ;
+}
+
+static void	ds2409Teardown(void) {
+	Fam1FCount	= 0 ;
+	RouteCount	= 0 ;
+	CouplerMask	= 0 ;
+	memset(Active, ds2409UNKNOWN, sizeof(Active)) ;		// branches possibly left on
+}
+
+static ow_family_t	sDS2409Drv = {
+	.pName		= "DS2409",
+	.Enumerate	= ds2409Enumerate,
+	.Teardown	= ds2409Teardown,
+} ;
+
+void	ds2409Register(void) {
+	ds2409Teardown() ;
+	OWFamilyRegister(OWFAMILY_1F, &sDS2409Drv) ;
+}
+
+#endif
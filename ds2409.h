@@ -0,0 +1,81 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2409.h - DS2409 MicroLAN coupler, main & auxiliary branches as sub-buses
+ */
+
+#pragma		once
+
+#include	"x_definitions.h"
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2409COUPLER_MAX					8			// couplers, all channels
+#define	ds2409ROUTE_MAX						128			// devices on channels with couplers
+
+#define	ds2409TRUNK							0			// device on the channel itself, or no branch on
+#define	ds2409UNKNOWN						0xFF		// coupler state not known, forces a switch
+#define	ds2409BRANCH(Coupler, Aux)			(1 + ((Coupler) << 1) + (Aux))
+
+/* Sweep group: devices sorted by group are handled channel by channel and, within a channel,
+ * branch by branch so that each coupler is switched at most once per sweep */
+#if		(halHAS_DS2409 == 1)
+	#define	ds2409GROUP(Ch, ROM)			(((Ch) << 8) | ds2409Route(ROM))
+#else
+	#define	ds2409GROUP(Ch, ROM)			((Ch) << 8)
+	#define	ds2409Wanted(ROM, Chan)			1			// flat bus, every device wanted
+#endif
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {				// DS2409 coupler
+	ow_rom_t	ROM ;
+	uint8_t		Ch ;
+} ds2409_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ds2409_t) == 9) ;
+
+typedef struct __attribute__((packed)) {				// device location
+	ow_rom_t	ROM ;
+	uint8_t		Ch ;
+	uint8_t		Branch ;								// ds2409TRUNK or ds2409BRANCH()
+} ds2409_route_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ds2409_route_t) == 10) ;
+
+// ###################################### Private functions ########################################
+
+#if		(halHAS_DS2409 == 1)
+uint8_t	ds2409Route(ow_rom_t ROM) ;
+int32_t	ds2409Select(uint8_t Chan, uint8_t Branch) ;
+int32_t	ds2409AllOff(uint8_t Chan) ;
+int32_t	ds2409Broadcast(uint8_t Chan, uint8_t Branch) ;
+int32_t	ds2409Wanted(ow_rom_t ROM, uint8_t Chan) ;
+void	ds2409Learn(ow_rom_t ROM, uint8_t Chan, uint8_t Branch) ;
+int32_t	ds2409EnumerateBranches(uint8_t Chan) ;
+int32_t	ds2409ScanBranches(uint8_t Chan, uint8_t Family, int (* Handler)(int32_t, void *), int32_t xCount, void * pVoid) ;
+void	ds2409Report(void) ;
+void	ds2409Register(void) ;
+#endif
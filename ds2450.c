@@ -0,0 +1,299 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2450.c - DS2450 quad A/D converter
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS2450 == 1)
+
+#include	"ds2450.h"
+#include	"ds2482.h"
+#include	"ds2409.h"
+#include	"ds2482arb.h"
+#include	"ds2482health.h"
+#include	"ds2482stats.h"
+#include	"owfamily.h"
+#include	"owpolicy.h"
+#include	"owxact.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdlib.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Sweeps follow the DS18x20 broadcast path: one Skip ROM Convert per channel starts all 4 inputs
+ * of every DS2450 on it, the inverted CRC16 sent after the command is identical for all devices
+ * so it can be checked in spite of the wired-AND. A single wait covers all channels, then each
+ * device costs one Read Memory of the result page (8 bytes + CRC16).
+ * Parasitic power needs the strong pullup right after the CRC16 is read, which the bridge can
+ * only arm ahead of a write, so the devices must be VCC powered. */
+
+ds2450_t *	psDS2450		= NULL ;
+uint8_t		Fam20Count		= 0 ;
+static	uint8_t	EnumIdx		= 0 ;
+
+// ####################################### Local functions #########################################
+
+static int32_t	ds2450CheckCRC16(uint16_t crc16) {
+	int32_t	Lsb = ds2482XactReadByte() ;
+	int32_t	Msb = ds2482XactReadByte() ;
+	if (Lsb < 0 || Msb < 0) {
+		return erFAILURE ;
+	}
+	return ((crc16 ^ 0xFFFF) == ((Msb << 8) | Lsb)) ? 1 : 0 ;
+}
+
+/**
+ * ds2450WriteMemory() - write & verify consecutive bytes of the control/status memory
+ * @brief	Each byte is followed by the inverted CRC16 and the byte read back from memory, the
+ * 			first CRC covers command, address & data, the next ones the new address & data
+ */
+static int32_t	ds2450WriteMemory(ds2450_t * psADC, uint16_t Addr, const uint8_t * pData, int32_t Len) {
+	uint8_t	Tx[3] = { Addr & 0xFF, Addr >> 8, pData[0] } ;
+	uint8_t	Cmd = DS2450_WRITE_MEM ;
+	ow_rom_t	sROM = psADC->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.pTx = Tx,	.Chan = psADC->Ch,	.Cmd = Cmd,	.TxLen = sizeof(Tx),
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+	} ;
+	if (ds2482Lock(psADC->Ch) != erSUCCESS) {
+		return erFAILURE ;
+	}
+	int32_t	iRV = OWXactRun(&sXact) ;
+	uint16_t crc16 = OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), Tx, sizeof(Tx)) ;
+	for (int32_t i = 0; iRV == 1; ) {
+		iRV = ds2450CheckCRC16(crc16) ;
+		if (iRV == 1) {
+			iRV = ds2482XactReadByte() ;
+			iRV = (iRV == pData[i]) ? 1 : (iRV < 0) ? erFAILURE : 0 ;
+		}
+		if (iRV != 1 || ++i == Len) {
+			break ;
+		}
+		Tx[0] = (Addr + i) & 0xFF ;
+		Tx[1] = (Addr + i) >> 8 ;
+		Tx[2] = pData[i] ;
+		crc16 = OWCalcCRC16(0, Tx, sizeof(Tx)) ;
+		iRV = (ds2482XactWriteByte(pData[i]) == erSUCCESS) ? 1 : erFAILURE ;
+	}
+	ds2482Unlock() ;
+	return iRV ;
+}
+
+static int32_t	ds2450Configure(ds2450_t * psADC) {
+	uint8_t	Ctrl[ds2450INPUTS * 2] ;
+	for (int32_t i = 0; i < ds2450INPUTS; ++i) {
+		Ctrl[i * 2]		= ds2450RESOLUTION & 0x0F ;		// RC3-0, 0 = 16 bits, no outputs
+		Ctrl[i * 2 + 1]	= ds2450RANGE_5V12 ;			// IR, alarms off, clears POR
+	}
+	int32_t	iRV = ds2450WriteMemory(psADC, DS2450_PAGE_CONTROL, Ctrl, sizeof(Ctrl)) ;
+	if (iRV == 1) {
+		const uint8_t Vcc = DS2450_VCC_ON ;
+		iRV = ds2450WriteMemory(psADC, DS2450_VCC_CTRL, &Vcc, sizeof(Vcc)) ;
+	}
+	IF_SL_ERR(iRV != 1, "Config failed %02X/%#M", psADC->ROM.Family, psADC->ROM.TagNum) ;
+	return iRV ;
+}
+
+/**
+ * ds2450Trigger() - start conversion of all inputs of every DS2450 on a channel
+ * @return	1 if the broadcast CRC16 matched, 0 if no presence or CRC error, erFAILURE
+ */
+static int32_t	ds2450Trigger(uint8_t Chan) {
+	uint8_t	Tx[2] = { (1 << ds2450INPUTS) - 1, 0x00 } ;	// all inputs, no preset
+	uint8_t	Cmd = DS2450_CONVERT ;
+	ow_xact_t	sXact = {
+		.pTx = Tx,	.Chan = Chan,	.Cmd = Cmd,	.TxLen = sizeof(Tx),
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+	} ;
+	if (ds2482Lock(Chan) != erSUCCESS) {
+		return erFAILURE ;
+	}
+	int32_t	iRV = OWXactRun(&sXact) ;
+	if (iRV == 1) {
+		iRV = ds2450CheckCRC16(OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), Tx, sizeof(Tx))) ;
+	}
+	ds2482Unlock() ;
+	return iRV ;
+}
+
+/**
+ * ds2450ReadResults() - read the result page in one block, CRC16 over command, address & data
+ */
+static int32_t	ds2450ReadResults(ds2450_t * psADC) {
+	uint8_t	TA[2] = { DS2450_PAGE_RESULT, 0x00 } ;
+	uint8_t	Rx[sizeof(psADC->Raw) + 2] ;
+	uint8_t	Cmd = DS2450_READ_MEM ;
+	ow_rom_t	sROM = psADC->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.pTx = TA,	.pRx = Rx,	.Chan = psADC->Ch,	.Cmd = Cmd,
+		.TxLen = sizeof(TA),	.RxLen = sizeof(Rx),
+		.Flags = owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+	} ;
+	int32_t	iRV ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_SCRATCHPAD, psADC->Ch) ;
+	do {
+		iRV = OWXactRun(&sXact) ;
+		if (iRV == 1) {
+			uint16_t crc16 = OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), TA, sizeof(TA)) ;
+			crc16 = OWCalcCRC16(crc16, Rx, sizeof(psADC->Raw)) ^ 0xFFFF ;
+			if (crc16 != ((Rx[sizeof(psADC->Raw) + 1] << 8) | Rx[sizeof(psADC->Raw)])) {
+				ds2482STAT_INC(CRCfail) ;
+				iRV = 0 ;
+			}
+		}
+	} while (iRV != 1 && OWRetryNext(&sRetry)) ;
+	ds2482HealthUpdate(psADC->Ch, iRV == 1) ;
+	if (iRV == 1) {
+		for (int32_t i = 0; i < ds2450INPUTS; ++i) {
+			psADC->Raw[i] = (Rx[i * 2 + 1] << 8) | Rx[i * 2] ;
+		}
+		IF_PRINT(debugRESULT, "%#M  A=%04X B=%04X C=%04X D=%04X\n", psADC->ROM.TagNum,
+				psADC->Raw[0], psADC->Raw[1], psADC->Raw[2], psADC->Raw[3]) ;
+	}
+	return iRV ;
+}
+
+// ################################### Global/public functions #####################################
+
+/**
+ * ds2450ConvertAndReadAll() - convert all inputs of all devices and read the results
+ * @return	erSUCCESS, or erFAILURE if any channel or device failed (last good values kept)
+ */
+int32_t	ds2450ConvertAndReadAll(void) {
+	if (Fam20Count == 0) {
+		return erSUCCESS ;
+	}
+	int32_t	iRV = erSUCCESS ;
+	uint8_t	SweepMask = 0 ;
+	uint16_t DoneGroup = 0xFFFF ;
+	ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+	for (int32_t Idx = 0; Idx < Fam20Count; ++Idx) {	// Phase 1: one broadcast per channel/branch
+		uint8_t	Chan = psDS2450[Idx].Ch ;
+		uint16_t Group = ds2409GROUP(Chan, psDS2450[Idx].ROM) ;	// enumeration order is grouped
+		if (Group == DoneGroup || ds2482HealthUsable(Chan) == 0) {
+			continue ;
+		}
+		DoneGroup = Group ;
+#if		(halHAS_DS2409 == 1)
+		if (ds2409Broadcast(Chan, Group & 0xFF) != erSUCCESS) {	// only this branch, or trunk only
+			iRV = erFAILURE ;
+			continue ;
+		}
+#endif
+		if (ds2450Trigger(Chan) == 1) {
+			SweepMask |= (1 << Chan) ;
+		} else {
+			ds2482HealthUpdate(Chan, 0) ;
+			iRV = erFAILURE ;
+		}
+		ds2482ArbYield() ;
+	}
+	if (SweepMask) {									// Phase 2: single wait, bus free
+		ds2482ArbRelease() ;
+		vTaskDelay(pdMS_TO_TICKS(ds2450DELAY_CONVERT) + 1) ;
+		ds2482ArbAcquire(ds2482PRIO_SENSOR) ;
+	}
+	for (int32_t Idx = 0; Idx < Fam20Count; ++Idx) {	// Phase 3: one block read per device
+		if ((SweepMask & (1 << psDS2450[Idx].Ch)) == 0) {
+			continue ;
+		}
+		ds2482ArbYield() ;
+		if (ds2450ReadResults(&psDS2450[Idx]) != 1) {
+			iRV = erFAILURE ;
+		}
+	}
+	ds2482ArbRelease() ;
+	return iRV ;
+}
+
+float	ds2450GetVoltage(int32_t Idx, int32_t Input) {
+	IF_myASSERT(debugPARAM, Idx < Fam20Count && Input < ds2450INPUTS) ;
+	return (float) psDS2450[Idx].Raw[Input] * (ds2450RANGE_5V12 ? 5.12f : 2.56f) / 65536.0f ;
+}
+
+// ################################ Family driver registry support #################################
+
+static int32_t	ds2450HandleEnumerate(int32_t iCount, void * pVoid) {
+	ds2450_t * psADC = &psDS2450[EnumIdx++] ;
+	memcpy(&psADC->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
+	psADC->Ch = sDS2482.CurChan ;
+	IF_EXEC_1(debugTRACK, ds2482PrintROM, psADC->ROM) ;
+	return erSUCCESS ;
+}
+
+static int32_t	ds2450Enumerate(ow_search_t * psS) {
+	++Fam20Count ;
+	return 0 ;
+}
+
+static int32_t	ds2450Discover(void) {
+	if (Fam20Count == 0) {
+		return erSUCCESS ;
+	}
+	psDS2450 = malloc(Fam20Count * sizeof(ds2450_t)) ;
+	IF_myASSERT(debugRESULT, INRANGE_SRAM(psDS2450)) ;
+	memset(psDS2450, 0, Fam20Count * sizeof(ds2450_t)) ;
+	EnumIdx = 0 ;
+	int32_t	iRV = ds2482ScanAllChannels(OWFAMILY_20, ds2450HandleEnumerate, NULL) ;
+	for (int32_t Idx = 0; Idx < iRV; ++Idx) {
+		ds2450Configure(&psDS2450[Idx]) ;
+	}
+	IF_PRINT(debugTRACK, "Fam20 Count=%d\n", Fam20Count) ;
+	if (iRV != Fam20Count) {
+		SL_ERR("Only %d/%d enumerated!!!", iRV, Fam20Count) ;
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static int32_t	ds2450Sweep(void * pVoid) { return ds2450ConvertAndReadAll() ; }
+
+static void	ds2450Teardown(void) {
+	free(psDS2450) ;
+	psDS2450	= NULL ;
+	Fam20Count	= 0 ;
+}
+
+static ow_family_t	sDS2450Drv = {
+	.pName		= "DS2450",
+	.Enumerate	= ds2450Enumerate,
+	.Discover	= ds2450Discover,
+	.Sweep		= ds2450Sweep,
+	.Teardown	= ds2450Teardown,
+} ;
+
+void	ds2450Register(void) { OWFamilyRegister(OWFAMILY_20, &sDS2450Drv) ; }
+
+#endif
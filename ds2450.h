@@ -0,0 +1,63 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2450.h - DS2450 quad A/D converter
+ */
+
+#pragma		once
+
+#include	"x_definitions.h"
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2450INPUTS						4
+#define	ds2450RESOLUTION					12			// bits, 1 to 16, same for all inputs
+#define	ds2450RANGE_5V12					1			// 1=5.12V 0=2.56V full scale
+#define	ds2450PWR_SOURCE					2			// 2=External (VCC), parasitic not supported
+
+// tCONV = inputs * bits * 80uS + 160uS offset, rounded up to mS
+#define	ds2450DELAY_CONVERT					(((ds2450INPUTS * ds2450RESOLUTION * 80) + 160 + 999) / 1000)
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {				// DS2450 quad A/D
+	ow_rom_t	ROM ;
+	uint8_t		Ch		: 3 ;							// Channel the device was discovered on
+	uint8_t		Spare	: 5 ;
+	uint16_t	Raw[ds2450INPUTS] ;						// left justified results, A..D
+} ds2450_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ds2450_t) == 17) ;
+
+// #################################### Public Data structures #####################################
+
+extern uint8_t Fam20Count ;
+extern ds2450_t * psDS2450 ;
+
+// ###################################### Private functions ########################################
+
+int32_t	ds2450ConvertAndReadAll(void) ;
+float	ds2450GetVoltage(int32_t Idx, int32_t Input) ;
+void	ds2450Register(void) ;
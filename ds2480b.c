@@ -0,0 +1,381 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2480b.c - DS2480B serial (UART) to 1-Wire line driver
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2480B == 1)
+
+#include	"ds2480b.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#if		(ESP32_PLATFORM == 1)
+	#include	"driver/uart.h"
+#else
+	#include	<fcntl.h>
+	#include	<termios.h>
+	#include	<unistd.h>
+#endif
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* The DS2480B powers up in command mode at 9600 baud. Command mode is used for reset, single bit
+ * and configuration, data mode for bytes: every byte written is sent on the 1-Wire and the byte
+ * read back returned, so a whole block is one serial write and one read. In data mode a 0xE3
+ * byte is a switch to command mode, it must be sent twice to go out as data.
+ * The search accelerator turns a ROM search into a single 16 byte data mode exchange per device:
+ * bits 2n+1 written select the direction to take at ROM bit n on a discrepancy, bits 2n read back
+ * flag a discrepancy and bits 2n+1 the direction taken. Since only odd bits are ever set in the
+ * bytes written, 0xE3 can not occur and no doubling is required. */
+
+ds2480b_t	sDS2480B = { 0 } ;
+
+// ################################### UART transport support ######################################
+
+#if		(ESP32_PLATFORM == 1)
+static int32_t	ds2480bUartOpen(int32_t Port, const char * pDev) {
+	const uart_config_t sConfig = {
+		.baud_rate	= ds2480bBAUD,
+		.data_bits	= UART_DATA_8_BITS,
+		.parity		= UART_PARITY_DISABLE,
+		.stop_bits	= UART_STOP_BITS_1,
+		.flow_ctrl	= UART_HW_FLOWCTRL_DISABLE,
+	} ;
+	if (uart_param_config(Port, &sConfig) != ESP_OK ||	// pins are board specific, set by the app
+		uart_driver_install(Port, 256, 0, 0, NULL, 0) != ESP_OK) {
+		return erFAILURE ;
+	}
+	return Port ;
+}
+
+static int32_t	ds2480bUartWrite(uint8_t * pBuf, size_t Len) {
+	return (uart_write_bytes(sDS2480B.Port, (const char *) pBuf, Len) == (int) Len) ? erSUCCESS : erFAILURE ;
+}
+
+static int32_t	ds2480bUartRead(uint8_t * pBuf, size_t Len) {
+	return uart_read_bytes(sDS2480B.Port, pBuf, Len, pdMS_TO_TICKS(ds2480bTIMEOUT_MS)) ;
+}
+
+static void	ds2480bUartFlush(void) { uart_flush_input(sDS2480B.Port) ; }
+
+static void	ds2480bUartBreak(void) {				// 0x00 at 1200 baud holds the line low 7.5mS
+	uint8_t	cChr = 0 ;
+	uart_set_baudrate(sDS2480B.Port, 1200) ;
+	uart_write_bytes(sDS2480B.Port, (const char *) &cChr, sizeof(cChr)) ;
+	uart_wait_tx_done(sDS2480B.Port, pdMS_TO_TICKS(ds2480bTIMEOUT_MS)) ;
+	uart_set_baudrate(sDS2480B.Port, ds2480bBAUD) ;
+}
+
+#else
+
+static int32_t	ds2480bUartOpen(int32_t Port, const char * pDev) {
+	(void) Port ;										// the device path selects the port
+	int32_t	fd = open(pDev, O_RDWR | O_NOCTTY) ;		// a tty or a pseudo terminal
+	if (fd < 0) {
+		return erFAILURE ;
+	}
+	struct termios sTIO ;
+	tcgetattr(fd, &sTIO) ;
+	cfmakeraw(&sTIO) ;
+	cfsetispeed(&sTIO, B9600) ;
+	cfsetospeed(&sTIO, B9600) ;
+	sTIO.c_cc[VMIN]		= 0 ;
+	sTIO.c_cc[VTIME]	= ds2480bTIMEOUT_MS / 100 ;		// deci-seconds
+	if (tcsetattr(fd, TCSANOW, &sTIO) != 0) {
+		close(fd) ;
+		return erFAILURE ;
+	}
+	return fd ;
+}
+
+static int32_t	ds2480bUartWrite(uint8_t * pBuf, size_t Len) {
+	return (write(sDS2480B.Port, pBuf, Len) == (ssize_t) Len) ? erSUCCESS : erFAILURE ;
+}
+
+static int32_t	ds2480bUartRead(uint8_t * pBuf, size_t Len) {
+	size_t	Count = 0 ;
+	while (Count < Len) {
+		ssize_t	iRV = read(sDS2480B.Port, pBuf + Count, Len - Count) ;
+		if (iRV <= 0) {									// timeout or error
+			break ;
+		}
+		Count += iRV ;
+	}
+	return Count ;
+}
+
+static void	ds2480bUartFlush(void) { tcflush(sDS2480B.Port, TCIOFLUSH) ; }
+
+static void	ds2480bUartBreak(void) { tcsendbreak(sDS2480B.Port, 0) ; }
+#endif
+
+/**
+ * ds2480bExchange() - one serial write followed by reading the expected response
+ * @return	erSUCCESS or erFAILURE
+ */
+static int32_t	ds2480bExchange(uint8_t * pTx, size_t TxLen, uint8_t * pRx, size_t RxLen) {
+	if (ds2480bUartWrite(pTx, TxLen) != erSUCCESS) {
+		return erFAILURE ;
+	}
+	if (RxLen && ds2480bUartRead(pRx, RxLen) != (int32_t) RxLen) {
+		SL_ERR("DS2480B short response") ;
+		sDS2480B.Mode = 0 ;								// unknown, force a mode switch
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static size_t	ds2480bModeSet(uint8_t * pBuf, uint8_t Mode) {
+	if (sDS2480B.Mode == Mode) {
+		return 0 ;
+	}
+	sDS2480B.Mode = Mode ;
+	*pBuf = Mode ;
+	return 1 ;
+}
+
+static uint8_t	ds2480bCrc8(uint8_t * pBuf, size_t Len) {
+	uint8_t	crc8 = 0 ;
+	while (Len--) {
+		crc8 ^= *pBuf++ ;
+		for (int32_t i = 0; i < BITS_IN_BYTE; ++i) {
+			crc8 = (crc8 & 1) ? (crc8 >> 1) ^ 0x8C : (crc8 >> 1) ;
+		}
+	}
+	return crc8 ;
+}
+
+// ################################## 1-Wire (owbus.h) interface ##################################
+
+static int32_t	ds2480bLock(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Chan == 0) ;
+	xSemaphoreTakeRecursive(sDS2480B.Mux, portMAX_DELAY) ;
+	return erSUCCESS ;
+}
+
+static void	ds2480bUnlock(void) { xSemaphoreGiveRecursive(sDS2480B.Mux) ; }
+
+static int32_t	ds2480bReset(void) {
+	uint8_t	cBuf[2], Resp ;
+	size_t	Len = ds2480bModeSet(cBuf, ds2480bMODE_COMMAND) ;
+	cBuf[Len++] = ds2480bCMD_RESET ;
+	if (ds2480bExchange(cBuf, Len, &Resp, sizeof(Resp)) != erSUCCESS) {
+		return erFAILURE ;
+	}
+	switch (Resp & 0x03) {
+	case ds2480bRST_PRESENCE:
+	case ds2480bRST_ALARM:	return 1 ;
+	case ds2480bRST_SHORT:	SL_ERR("1-Wire short") ;	// fall through
+	default:				return 0 ;
+	}
+}
+
+static uint8_t	ds2480bTouchBit(uint8_t Bit) {
+	uint8_t	cBuf[2], Resp ;
+	size_t	Len = ds2480bModeSet(cBuf, ds2480bMODE_COMMAND) ;
+	cBuf[Len++] = ds2480bCMD_BIT | ((Bit & 1) ? 0x10 : 0x00) ;
+	if (ds2480bExchange(cBuf, Len, &Resp, sizeof(Resp)) != erSUCCESS) {
+		return 0 ;
+	}
+	return ((Resp & 0x03) == 0x03) ? 1 : 0 ;
+}
+
+/**
+ * ds2480bBlock() - stream bytes in data mode, each chunk is a single serial write & read
+ * @return	Len or erFAILURE
+ */
+static int32_t	ds2480bBlock(uint8_t * pBuf, int32_t Len) {
+	uint8_t	cBuf[1 + (ds2480bCHUNK * 2)] ;				// mode switch + worst case all 0xE3
+	for (int32_t Done = 0; Done < Len; ) {
+		int32_t	Count = Len - Done ;
+		if (Count > ds2480bCHUNK) {
+			Count = ds2480bCHUNK ;
+		}
+		size_t	TxLen = ds2480bModeSet(cBuf, ds2480bMODE_DATA) ;
+		for (int32_t Idx = 0; Idx < Count; ++Idx) {
+			cBuf[TxLen++] = pBuf[Done + Idx] ;
+			if (pBuf[Done + Idx] == ds2480bMODE_COMMAND) {
+				cBuf[TxLen++] = ds2480bMODE_COMMAND ;	// escape, only 1 byte comes back
+			}
+		}
+		if (ds2480bExchange(cBuf, TxLen, &pBuf[Done], Count) != erSUCCESS) {
+			return erFAILURE ;
+		}
+		Done += Count ;
+	}
+	return Len ;
+}
+
+static int32_t	ds2480bWriteByte(uint8_t Byte) {
+	uint8_t	cEcho = Byte ;
+	if (ds2480bBlock(&cEcho, sizeof(cEcho)) != sizeof(cEcho)) {
+		return erFAILURE ;
+	}
+	return (cEcho == Byte) ? erSUCCESS : erFAILURE ;	// a 0 read back means bus contention
+}
+
+static int32_t	ds2480bReadByte(void) {
+	uint8_t	cRead = 0xFF ;
+	return (ds2480bBlock(&cRead, sizeof(cRead)) == sizeof(cRead)) ? cRead : erFAILURE ;
+}
+
+/**
+ * ds2480bSearch() - find the next device using the search accelerator
+ * @brief	Same state & semantics as OWSearchNext() (AN187), incl. family targeting with
+ * 			LastDiscrepancy = 64, but reset + one exchange per device instead of 64 triplets
+ * @return	1 if a device was found, 0 if no (more) devices, erFAILURE on transport failure
+ */
+static int32_t	ds2480bSearch(ow_search_t * psS) {
+	ds2480bLock(psS->Chan) ;
+	if (psS->LastDeviceFlag == 0) {
+		int32_t	iRV = ds2480bReset() ;
+		if (iRV == 1) {
+			uint8_t	cBuf[24], cRx[17] ;
+			size_t	Len = ds2480bModeSet(cBuf, ds2480bMODE_DATA) ;
+			cBuf[Len++]	= OW_CMD_SEARCHROM ;
+			cBuf[Len++]	= ds2480bMODE_COMMAND ;
+			cBuf[Len++]	= ds2480bCMD_SRCH_ON ;
+			cBuf[Len++]	= ds2480bMODE_DATA ;
+			uint8_t * pSrch = &cBuf[Len] ;
+			memset(pSrch, 0, 16) ;
+			for (int32_t Bit = 0; Bit < 64; ++Bit) {		// path up to & including LastDiscrepancy
+				int32_t	Dir = (Bit < psS->LastDiscrepancy - 1) ? (psS->ROM.HexChars[Bit / 8] >> (Bit % 8)) & 1
+							: (Bit == psS->LastDiscrepancy - 1) ? 1 : 0 ;
+				pSrch[(Bit * 2 + 1) / 8] |= Dir << ((Bit * 2 + 1) % 8) ;
+			}
+			Len += 16 ;
+			cBuf[Len++]	= ds2480bMODE_COMMAND ;
+			cBuf[Len++]	= ds2480bCMD_SRCH_OFF ;
+			sDS2480B.Mode = ds2480bMODE_COMMAND ;
+			iRV = ds2480bExchange(cBuf, Len, cRx, sizeof(cRx)) ;	// 0xF0 echo + 16 bytes
+			if (iRV != erSUCCESS) {
+				ds2480bUnlock() ;
+				return erFAILURE ;
+			}
+			int32_t	LastZero = 0 ;
+			for (int32_t Bit = 0; Bit < 64; ++Bit) {
+				uint8_t	Flag = (cRx[1 + (Bit * 2) / 8] >> ((Bit * 2) % 8)) & 1 ;
+				uint8_t	Dir = (cRx[1 + (Bit * 2 + 1) / 8] >> ((Bit * 2 + 1) % 8)) & 1 ;
+				if (Dir) {
+					psS->ROM.HexChars[Bit / 8] |= (1 << (Bit % 8)) ;
+				} else {
+					psS->ROM.HexChars[Bit / 8] &= ~(1 << (Bit % 8)) ;
+					if (Flag) {							// discrepancy, 0 path taken
+						LastZero = Bit + 1 ;
+						if (Bit < 8) {
+							psS->LastFamilyDiscrepancy = LastZero ;
+						}
+					}
+				}
+			}
+			psS->crc8 = ds2480bCrc8(psS->ROM.HexChars, sizeof(ow_rom_t)) ;
+			if (psS->crc8 == 0 && psS->ROM.Family != 0) {
+				psS->LastDiscrepancy	= LastZero ;
+				psS->LastDeviceFlag		= (LastZero == 0) ? 1 : 0 ;
+				ds2480bUnlock() ;
+				return 1 ;
+			}
+			IF_PRINT(debugRESULT, "Search CRC fail %'-+b\n", sizeof(ow_rom_t), psS->ROM.HexChars) ;
+		} else if (iRV == erFAILURE) {
+			ds2480bUnlock() ;
+			return erFAILURE ;
+		}
+	}
+	ds2480bUnlock() ;
+	uint8_t	Chan = psS->Chan ;								// not found or done, reset for next time
+	memset(psS, 0, sizeof(ow_search_t)) ;
+	psS->Chan = Chan ;
+	return 0 ;
+}
+
+const ow_bus_t	ds2480bBus = {
+	.pName		= "DS2480B",
+	.Lock		= ds2480bLock,
+	.Unlock		= ds2480bUnlock,
+	.Reset		= ds2480bReset,
+	.TouchBit	= ds2480bTouchBit,
+	.WriteByte	= ds2480bWriteByte,
+	.ReadByte	= ds2480bReadByte,
+	.Block		= ds2480bBlock,
+	.Search		= ds2480bSearch,
+} ;
+
+// ################### Identification, Diagnostics & Configuration functions #######################
+
+/**
+ * ds2480bDetect() - master reset, calibrate with the timing byte and verify the response
+ * @return	1 if a DS2480B responded as expected, else 0
+ */
+static int32_t	ds2480bDetect(void) {
+	ds2480bUartBreak() ;
+	vTaskDelay(pdMS_TO_TICKS(2)) ;
+	ds2480bUartFlush() ;
+	uint8_t	cBuf[5] = { ds2480bCMD_RESET } ;				// timing byte, no response
+	if (ds2480bUartWrite(cBuf, 1) != erSUCCESS) {
+		return 0 ;
+	}
+	vTaskDelay(pdMS_TO_TICKS(4)) ;
+	ds2480bUartFlush() ;
+	sDS2480B.Mode = ds2480bMODE_COMMAND ;
+	cBuf[0]	= ds2480bCFG_SLEW ;
+	cBuf[1]	= ds2480bCFG_W1LT ;
+	cBuf[2]	= ds2480bCFG_DSO ;
+	cBuf[3]	= ds2480bCFG_RD_BAUD ;
+	cBuf[4]	= ds2480bCMD_BIT | 0x10 ;
+	uint8_t	cRx[5] ;
+	if (ds2480bExchange(cBuf, sizeof(cBuf), cRx, sizeof(cRx)) != erSUCCESS) {
+		return 0 ;
+	}
+	IF_PRINT(debugTRACK, "DS2480B %'-+b\n", sizeof(cRx), cRx) ;
+	return (cRx[3] == 0x00 && (cRx[4] & 0xF0) == 0x90) ? 1 : 0 ;	// 9600 baud, bit response
+}
+
+/**
+ * ds2480bIdentify() - open the UART, detect the DS2480B and make it the active 1-Wire bus
+ * @param	Port	UART number (ESP32)
+ * @param	pDev	device path, also a pseudo terminal, (POSIX)
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	ds2480bIdentify(int32_t Port, const char * pDev) {
+	sDS2480B.Port = ds2480bUartOpen(Port, pDev) ;
+	if (sDS2480B.Port < 0 || ds2480bDetect() == 0) {
+		SL_ERR("DS2480B not found") ;
+		return erFAILURE ;
+	}
+	sDS2480B.Mux = xSemaphoreCreateRecursiveMutex() ;
+	OWBusSelect(&ds2480bBus) ;
+	return erSUCCESS ;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2480b.h - DS2480B serial (UART) to 1-Wire line driver
+ */
+
+#pragma		once
+
+#include	"owbus.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2480bBAUD							9600		// power-on rate, timing byte calibrates to it
+#define	ds2480bTIMEOUT_MS					100			// response timeout, longest is a 64 byte block
+#define	ds2480bCHUNK						64			// 1-Wire bytes per serial write in data mode
+
+// Mode switch & command mode commands, speed bits 3:2 = 01 flexible (slew controlled)
+#define	ds2480bMODE_DATA					0xE1
+#define	ds2480bMODE_COMMAND					0xE3		// in data mode must be sent twice to be data
+#define	ds2480bSPEED						0x04
+#define	ds2480bCMD_RESET					(0xC1 | ds2480bSPEED)
+#define	ds2480bCMD_BIT						(0x81 | ds2480bSPEED)	// | 0x10 to write (read) a 1
+#define	ds2480bCMD_SRCH_ON					(0xB1 | ds2480bSPEED)	// search accelerator
+#define	ds2480bCMD_SRCH_OFF					(0xA1 | ds2480bSPEED)
+
+// Configuration commands, each returns a response byte
+#define	ds2480bCFG_SLEW						0x17		// pulldown slew rate 1.37V/uS
+#define	ds2480bCFG_W1LT						0x45		// write-1 low time 10uS
+#define	ds2480bCFG_DSO						0x5B		// data sample offset 8uS
+#define	ds2480bCFG_RD_BAUD					0x0F		// read back the baud rate parameter
+
+// Reset response bits 1:0
+#define	ds2480bRST_SHORT					0x00
+#define	ds2480bRST_PRESENCE					0x01
+#define	ds2480bRST_ALARM					0x02
+#define	ds2480bRST_NONE						0x03
+
+// ######################################### Structures ############################################
+
+typedef struct {
+	SemaphoreHandle_t	Mux ;
+	int32_t		Port ;									// UART number or file descriptor
+	uint8_t		Mode ;									// ds2480bMODE_DATA or _COMMAND
+} ds2480b_t ;
+
+// #################################### Public Data structures #####################################
+
+extern ds2480b_t	sDS2480B ;
+extern const ow_bus_t ds2480bBus ;
+
+// ###################################### Private functions ########################################
+
+int32_t	ds2480bIdentify(int32_t Port, const char * pDev) ;
@@ -24,9 +24,20 @@
 
 #include	"x_config.h"
 
-#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1)
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
 
 #include	"ds2482.h"
+#include	"ds2482stats.h"
+#include	"ds2482trace.h"
+#include	"owxact.h"
+#include	"owbus.h"
+#include	"owfamily.h"
+#include	"ds2409.h"
+#include	"ds2482health.h"
+#include	"ds2482arb.h"
+#include	"owpolicy.h"
+#include	"owevents.h"
+#include	"owromidx.h"
 #include	"task_events.h"
 
 #include	"rules_engine.h"
@@ -69,6 +80,7 @@
 #define	debugBUS_CFG				(debugFLAG & 0x0002)
 #define	debugCONFIG					(debugFLAG & 0x0004)
 #define	debugCRC					(debugFLAG & 0x0008)
+#define	debugLOCK					(debugFLAG & 0x0010)
 
 #define	debugTRACK					(debugFLAG & 0x2000)
 #define	debugPARAM					(debugFLAG & 0x4000)
@@ -100,11 +112,99 @@
 	// Used to fix the incorrect logical to physical 1-Wire mapping
 	const	uint8_t	OWremapTable[ds2482NUM_CHAN]	= { 3,	2,	1,	0,	4,	5,	6,	7 } ;
 #endif
+
+// Registers readable per bridge type, the -10x and DS2484 have no channel select register
+#if		(halHAS_DS2482_800 == 1)
+	const	uint8_t	ds2482RegMap[]	= { ds2482REG_STAT, ds2482REG_DATA, ds2482REG_CHAN, ds2482REG_CONF } ;
+#else
+	const	uint8_t	ds2482RegMap[]	= { ds2482REG_STAT, ds2482REG_DATA, ds2482REG_CONF } ;
+#endif
 uint8_t	ChannelCount[ds2482NUM_CHAN] 	= { 0 } ;
+#if		(halHAS_DS2484 == 1)
+	static uint8_t	ds2484Profile	= ds2484PROF_DEFAULT ;
+	static uint8_t	ds2484PortCfg[ds2484PORT_NUM] ;		// read back after each adjust
+#endif
 ds2482_t sDS2482		= { 0 } ;
 
+// ############################## DS2482-800 I2C transaction support ##############################
+
+/* All I2C traffic to the bridge passes through these 3 functions, keep it that way since they
+ * are the single point where transactions and bytes are counted and traced */
+
+#if		(ds2482TRACE == 1)
+	#define	ds2482TRACE_REC(Op, pTx, TxLen, pRx, RxLen, Res)	\
+		ds2482TraceRecord(Op, sDS2482.sI2Cdev.addrI2C, pTx, TxLen, pRx, RxLen, Res)
+#else
+	#define	ds2482TRACE_REC(Op, pTx, TxLen, pRx, RxLen, Res)
+#endif
+
+static int32_t ds2482I2C_Write(uint8_t * pTxBuf, size_t TxSize) {
+	int32_t iRV = halI2C_Write(&sDS2482.sI2Cdev, pTxBuf, TxSize) ;
+	ds2482TRACE_REC(ds2482TR_WRITE, pTxBuf, TxSize, NULL, 0, iRV) ;
+	ds2482STAT_INC(I2Ctrans) ;
+	ds2482STAT_ADD(I2Cbytes, TxSize) ;
+	if (iRV != erSUCCESS) {
+		ds2482STAT_INC(I2Cerrors) ;
+	}
+	return iRV ;
+}
+
+static int32_t ds2482I2C_Read(uint8_t * pRxBuf, size_t RxSize) {
+	int32_t iRV = halI2C_Read(&sDS2482.sI2Cdev, pRxBuf, RxSize) ;
+	ds2482TRACE_REC(ds2482TR_READ, NULL, 0, pRxBuf, RxSize, iRV) ;
+	ds2482STAT_INC(I2Ctrans) ;
+	ds2482STAT_ADD(I2Cbytes, RxSize) ;
+	if (iRV != erSUCCESS) {
+		ds2482STAT_INC(I2Cerrors) ;
+	}
+	return iRV ;
+}
+
+static int32_t ds2482I2C_WriteRead(uint8_t * pTxBuf, size_t TxSize, uint8_t * pRxBuf, size_t RxSize) {
+	int32_t iRV = halI2C_WriteRead(&sDS2482.sI2Cdev, pTxBuf, TxSize, pRxBuf, RxSize) ;
+	ds2482TRACE_REC(ds2482TR_WRITEREAD, pTxBuf, TxSize, pRxBuf, RxSize, iRV) ;
+	ds2482STAT_INC(I2Ctrans) ;
+	ds2482STAT_ADD(I2Cbytes, TxSize + RxSize) ;
+	if (iRV != erSUCCESS) {
+		ds2482STAT_INC(I2Cerrors) ;
+	}
+	return iRV ;
+}
+
 // ############################## DS2482-800 CORE support functions ################################
 
+/**
+ * ds2482ShadowInvalidate() - forget the shadowed read pointer, channel & configuration
+ * @brief	Used on any path where the device state can no longer be trusted, the next
+ * 			SRP, CHSL and WCFG will then always be sent
+ */
+void	ds2482ShadowInvalidate(void) {
+	sDS2482.PntrValid	= 0 ;
+	sDS2482.ChanValid	= 0 ;
+	sDS2482.ConfValid	= 0 ;
+}
+
+/**
+ * ds2482Lock() - lock the bridge for one transaction and select the channel
+ * @brief	Recursive, so can be nested inside an arbitration session (ds2482arb.c) or an
+ * 			outer transaction. Hold it for one addressed transaction (reset .. last byte) only.
+ * @return	erSUCCESS, else the channel select failed and the lock is NOT held
+ */
+int32_t	ds2482Lock(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	xSemaphoreTakeRecursive(sDS2482.Mux, portMAX_DELAY) ;
+#if		(halHAS_DS2482_800 == 1)
+	int32_t	iRV = ds2482ChannelSelect(Chan) ;			// elided if already selected
+	if (iRV != erSUCCESS) {
+		xSemaphoreGiveRecursive(sDS2482.Mux) ;
+		return iRV ;
+	}
+#endif
+	return erSUCCESS ;
+}
+
+void	ds2482Unlock(void) { xSemaphoreGiveRecursive(sDS2482.Mux) ; }
+
 /**
  * Perform a device reset on the DS2482
  * Returns: true if device was reset
@@ -117,32 +217,81 @@ int32_t ds2482Reset(void) {
 //  SS status byte to read to verify state
 	uint8_t	cChr = CMD_DRST ;
 	uint8_t status ;
-	int32_t iRV = halI2C_WriteRead(&sDS2482.sI2Cdev, &cChr, sizeof(cChr), &status, sizeof(status)) ;
-	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-	NE_RETURN(iRV, erSUCCESS) ;
+	if (ds2482I2C_WriteRead(&cChr, sizeof(cChr), &status, sizeof(status)) != erSUCCESS) {
+		ds2482ShadowInvalidate() ;						// absent bridge is not detected
+		return 0 ;
+	}
+	// device reset: pointer to STAT, channel 0 selected and configuration cleared
 	sDS2482.Regs.Rstat	= status ;
 	sDS2482.RegPntr		= ds2482REG_STAT ;
 	sDS2482.CurChan		= 0 ;
+	sDS2482.ConfLast	= 0 ;
+	sDS2482.PntrValid	= 1 ;
+	sDS2482.ChanValid	= 1 ;
+	sDS2482.ConfValid	= 1 ;
 	return ((status & ~STATUS_LL) == STATUS_RST) ;		// RESET true or false...
 }
 
+/**
+ * ds2482Recover() - reset the bridge after a failed operation and restore its state
+ * @brief	A device reset selects channel 0 and clears the configuration (APU off), so the
+ * 			configuration (less SPU, a strong pullup is never re-armed) and the active channel
+ * 			are written back: DRST + WCFG + CHSL, the last two elided if already the defaults.
+ * 			On a DS2484 a non default port timing profile is re-applied instead of the CHSL.
+ * 			The interrupted operation must then restart from its last 1-Wire reset.
+ * @return	erSUCCESS or erFAILURE if the bridge did not recover
+ */
+int32_t	ds2482Recover(void) {
+	uint8_t	Chan = sDS2482.CurChan ;
+	ds2482STAT_INC(Recoveries) ;						// counted against the failing channel
+	if (ds2482Reset() != 1) {
+		ds2482ShadowInvalidate() ;
+		return erFAILURE ;
+	}
+	sDS2482.Regs.SPU = 0 ;
+	if (ds2482WriteConfig() != 1) {
+		return erFAILURE ;
+	}
+#if		(halHAS_DS2482_800 == 1)
+	if (ds2482ChannelSelect(Chan) != erSUCCESS) {
+		return erFAILURE ;
+	}
+#elif	(halHAS_DS2484 == 1)
+	if (ds2484Profile != ds2484PROF_DEFAULT &&			// device reset restored the defaults
+		ds2484PortProfile(ds2484Profile) != erSUCCESS) {
+		return erFAILURE ;
+	}
+#endif
+	IF_PRINT(debugTRACK, "Ch%d recovered\n", Chan) ;
+	return erSUCCESS ;
+}
+
 /**
  * DS2482_SetReadPointer()
  * Once set the pointer remains static to allow reread of same (normally status) register
  * Read Pointer will be changed by a new SRP command or by a device reset
  */
 int32_t	ds2482SetReadPointer(uint8_t Reg) {
+#if		(halHAS_DS2484 == 1)
+	IF_myASSERT(debugPARAM, Reg <= ds2484REG_PCFG && Reg != ds2482REG_CHAN) ;
+#else
 	IF_myASSERT(debugPARAM, Reg < ds2482REG_NUM) ;
-	if (sDS2482.RegPntr == Reg) {
+#endif
+	if (sDS2482.PntrValid && sDS2482.RegPntr == Reg) {
+		ds2482STAT_INC(Elided) ;
 		return erSUCCESS ;
 	}
 	// build the register read code from register number
 	uint8_t	cBuf[2] = { CMD_SRP, (~Reg << 4) | Reg } ;
-	int32_t iRV = halI2C_Write(&sDS2482.sI2Cdev, cBuf, sizeof(cBuf)) ;
+	int32_t iRV = ds2482I2C_Write(cBuf, sizeof(cBuf)) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-	NE_RETURN(iRV, erSUCCESS) ;
+	if (iRV != erSUCCESS) {
+		sDS2482.PntrValid = 0 ;
+		return iRV ;
+	}
 	// update the read pointer
-	sDS2482.RegPntr = Reg ;
+	sDS2482.RegPntr		= Reg ;
+	sDS2482.PntrValid	= 1 ;
 	return erSUCCESS ;
 }
 
@@ -161,15 +310,26 @@ int32_t ds2482WriteConfig(void) {
 //  CF configuration byte to write
 	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0) ;				// check that bus not busy
 	uint8_t	config = sDS2482.Regs.Rconf & 0x0F ;
+	if (sDS2482.ConfValid && sDS2482.ConfLast == config) {
+		ds2482STAT_INC(Elided) ;
+		return 1 ;
+	}
 	// calc config MSNibble based on the LSNibble value
 	uint8_t	cBuf[2] = { CMD_WCFG , (~config << 4) | config } ;
 	uint8_t new_conf ;
-	int32_t iRV = halI2C_WriteRead(&sDS2482.sI2Cdev, cBuf, sizeof(cBuf), &new_conf, sizeof(new_conf)) ;
+	int32_t iRV = ds2482I2C_WriteRead(cBuf, sizeof(cBuf), &new_conf, sizeof(new_conf)) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-	NE_RETURN(iRV, erSUCCESS) ;
+	if (iRV != erSUCCESS) {
+		sDS2482.ConfValid	= 0 ;
+		sDS2482.PntrValid	= 0 ;
+		return iRV ;
+	}
 	// update the saved configuration
 	sDS2482.Regs.Rconf	= new_conf ;
+	sDS2482.ConfLast	= new_conf & 0x0F ;
+	sDS2482.ConfValid	= 1 ;
 	sDS2482.RegPntr		= ds2482REG_CONF ;
+	sDS2482.PntrValid	= 1 ;
 	return 1 ;
 }
 
@@ -189,42 +349,148 @@ int32_t ds2482ChannelSelect(uint8_t Chan) {
 //  RR channel read back
 	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
 	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0) ;// check that bus not busy
+	if (sDS2482.ChanValid && sDS2482.CurChan == Chan) {
+		ds2482STAT_INC(Elided) ;
+		return erSUCCESS ;
+	}
 	uint8_t	cBuf[2] = { CMD_CHSL, ds2482_N2S[Chan] } ;
 	uint8_t ChanRet ;
-	int32_t iRV = halI2C_WriteRead(&sDS2482.sI2Cdev, cBuf, sizeof(cBuf), &ChanRet, sizeof(ChanRet)) ;
+	if (sDS2482.ConfLast & CONFIG_SPU) {				// may end a strong pullup
+		sDS2482.ConfValid = 0 ;
+	}
+	int32_t iRV = ds2482I2C_WriteRead(cBuf, sizeof(cBuf), &ChanRet, sizeof(ChanRet)) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-	NE_RETURN(iRV, erSUCCESS) ;
+	if (iRV != erSUCCESS) {
+		sDS2482.ChanValid	= 0 ;
+		sDS2482.PntrValid	= 0 ;
+		return iRV ;
+	}
 
 	sDS2482.RegPntr		= ds2482REG_CHAN ;			// update the read pointer
+	sDS2482.PntrValid	= 1 ;
 	sDS2482.Regs.Rchan	= ChanRet ;					// update channel code (read back)
 	/* value read back not same as the channel number sent so verify the return
 	 * against the code expected, but store the actual channel number if successful */
 	if (ChanRet != ds2482_V2N[Chan]) {
 		SL_ERR("Read %d != %d Expected", ChanRet, ds2482_V2N[Chan]) ;
 		IF_myASSERT(debugRESULT, 0) ;
+		sDS2482.ChanValid	= 0 ;
 		return erFAILURE ;
 	}
 	sDS2482.CurChan		= Chan ;					// and the actual (normalized) channel number
+	sDS2482.ChanValid	= 1 ;
+	return erSUCCESS ;
+}
+#endif
+
+#if		(halHAS_DS2484 == 1)
+/* Standard speed parameters only, overdrive values are left at their defaults. The SHORT profile
+ * trims reset low to the 480uS spec minimum and cuts recovery, which dominates slot time when the
+ * bus capacitance is low. Sample time (tMSP) is left alone, presence margin is not worth a few uS */
+static const uint8_t ds2484Profiles[ds2484PROF_NUM][5] = {
+	[ds2484PROF_DEFAULT]	= {
+		ds2484PARAM(ds2484P_tRSTL, 0, 0x6),				// 560uS
+		ds2484PARAM(ds2484P_tMSP, 0, 0x6),
+		ds2484PARAM(ds2484P_tW0L, 0, 0x6),				// 64uS
+		ds2484PARAM(ds2484P_tREC0, 0, 0x6),				// 5.25uS
+		ds2484PARAM(ds2484P_RWPU, 0, 0x6),
+	},
+	[ds2484PROF_SHORT]		= {
+		ds2484PARAM(ds2484P_tRSTL, 0, 0x2),				// 480uS
+		ds2484PARAM(ds2484P_tMSP, 0, 0x6),
+		ds2484PARAM(ds2484P_tW0L, 0, 0x4),				// 60uS
+		ds2484PARAM(ds2484P_tREC0, 0, 0x0),				// 2.75uS
+		ds2484PARAM(ds2484P_RWPU, 0, 0x6),
+	},
+} ;
+
+/**
+ * ds2484PortConfig() - Adjust 1-Wire Port timing and/or pull-up, verify against the read back
+ * @param	pParam		parameter bytes, each built with ds2484PARAM()
+ * @param	Count		number of parameter bytes
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	ds2484PortConfig(const uint8_t * pParam, size_t Count) {
+// Adjust 1-Wire Port
+//	S AD,0 [A] APORT [A] PP [A] .. PP [A] Sr AD,1 [A] [P0] A .. [P7] A\ P
+//  [] indicates from slave
+//  PP parameter byte(s), P0..P7 port configuration (tRSTL, tRSTL OD, tMSP, tMSP OD, tW0L,
+//  tW0L OD, tREC0, RWPU) value in the low nibble
+	IF_myASSERT(debugPARAM, Count > 0 && Count <= ds2484PORT_NUM) ;
+	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0) ;
+	uint8_t	cBuf[1 + ds2484PORT_NUM] ;
+	cBuf[0] = CMD_APORT ;
+	memcpy(&cBuf[1], pParam, Count) ;
+	int32_t iRV = ds2482I2C_WriteRead(cBuf, 1 + Count, ds2484PortCfg, sizeof(ds2484PortCfg)) ;
+	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+	if (iRV != erSUCCESS) {
+		sDS2482.PntrValid	= 0 ;
+		return iRV ;
+	}
+	sDS2482.RegPntr		= ds2484REG_PCFG ;
+	sDS2482.PntrValid	= 1 ;
+	for (size_t Idx = 0; Idx < Count; ++Idx) {
+		uint8_t	Par = pParam[Idx] >> 5 ;
+		uint8_t	Pos = (Par < ds2484P_tREC0) ? (Par * 2) + ((pParam[Idx] >> 4) & 1) : Par + 3 ;
+		if ((ds2484PortCfg[Pos] & 0x0F) != (pParam[Idx] & 0x0F)) {
+			SL_ERR("Port P%d=0x%X != 0x%X", Par, ds2484PortCfg[Pos] & 0x0F, pParam[Idx] & 0x0F) ;
+			return erFAILURE ;
+		}
+	}
 	return erSUCCESS ;
 }
+
+/**
+ * ds2484PortProfile() - select a timing profile, replayed by ds2482Recover()
+ */
+int32_t	ds2484PortProfile(uint8_t Profile) {
+	IF_myASSERT(debugPARAM, Profile < ds2484PROF_NUM) ;
+	ds2484Profile = Profile ;
+	return ds2484PortConfig(ds2484Profiles[Profile], sizeof(ds2484Profiles[Profile])) ;
+}
 #endif
 
+/**
+ * ds2482Shadow1W() - update the shadow state after a 1-Wire command was sent
+ * @brief	Strong pullup is armed by WCFG, started by the next 1-Wire command and the device
+ * 			clears SPU itself when the pullup ends, so the shadowed config is no longer known
+ */
+static void	ds2482Shadow1W(int32_t iRV) {
+	if (sDS2482.ConfLast & CONFIG_SPU) {
+		sDS2482.ConfValid = 0 ;
+	}
+	if (iRV != erSUCCESS) {
+		sDS2482.PntrValid = 0 ;
+	} else {
+		sDS2482.RegPntr		= ds2482REG_STAT ;			// all 1-Wire commands point to STAT
+		sDS2482.PntrValid	= 1 ;
+	}
+}
+
 int32_t	ds2482Write(uint8_t * pTxBuf, size_t TxSize) {
 	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0)	;
-	int32_t iRV = halI2C_Write(&sDS2482.sI2Cdev, pTxBuf, TxSize) ;
+	int32_t iRV = ds2482I2C_Write(pTxBuf, TxSize) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+	ds2482Shadow1W(iRV) ;
 	return iRV ;
 }
 
 int32_t	ds2482WaitNotBusy(int32_t Delay) {
-	int32_t	iRV, Retry = 20 ;
+	int32_t	iRV ;
 	uint8_t	Status ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_BUSY, sDS2482.CurChan) ;
 	do {
 		vTaskDelay(Delay) ;
-		iRV = halI2C_Read(&sDS2482.sI2Cdev, &Status, sizeof(Status)) ;
+		iRV = ds2482I2C_Read(&Status, sizeof(Status)) ;
 		IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
-	} while ((Status & STATUS_1WB) && --Retry) ;
-	if (Retry == 0 || (Status & STATUS_1WB)) {
+		ds2482STAT_INC(BusyPolls) ;
+		if (iRV != erSUCCESS) {							// Status not valid
+			sDS2482.PntrValid = 0 ;
+			return iRV ;
+		}
+	} while ((Status & STATUS_1WB) && OWRetryNext(&sRetry)) ;
+	if (Status & STATUS_1WB) {
 		IF_myASSERT(debugRESULT, 0) ;
 		return erFAILURE ;
 	}
@@ -248,15 +514,96 @@ int32_t	ds2482WriteAndWait(uint8_t * pTxBuf, size_t TxSize, size_t Delay) {
 	return iRV ;
 }
 
+// ######################## DS2482-800 fused byte level transaction support ########################
+
+/* Used by the transaction engine (owxact.c) to move bytes with the fewest I2C transactions:
+ * - the 1-Wire command and the first status read share one repeated start transfer,
+ * - busy polling spins without yielding, a byte (584uS standard, 70uS overdrive) is only a few
+ *   status reads at 400KHz, ds2482POLL_BURST status bytes per read transaction, falling back to
+ *   ds2482WaitNotBusy() only if still busy after ds2482POLL_SPIN status bytes,
+ * - the SRP to DATA and the data read share one repeated start transfer. */
+
+static int32_t	ds2482XactCommand(uint8_t * pTxBuf, size_t TxSize) {
+// 1-Wire command (Case B)
+//	S AD,0 [A] CMD [A] [DD [A]] Sr AD,1 [A] [Status] A [Status] A\ P
+//										\--------/
+//							Repeat until 1WB bit has changed to 0
+	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0)	;
+	uint8_t	Status ;
+	int32_t iRV = ds2482I2C_WriteRead(pTxBuf, TxSize, &Status, sizeof(Status)) ;
+	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+	ds2482Shadow1W(iRV) ;
+	NE_RETURN(iRV, erSUCCESS) ;
+	ds2482STAT_INC(BusyPolls) ;
+	uint8_t	Burst[ds2482POLL_BURST] ;
+	for (int32_t Spin = 1; (Status & STATUS_1WB) && Spin < ds2482POLL_SPIN; Spin += ds2482POLL_BURST) {
+		iRV = ds2482I2C_Read(Burst, sizeof(Burst)) ;	// ACK'ed reads keep returning STAT
+		IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+		if (iRV != erSUCCESS) {
+			sDS2482.PntrValid = 0 ;
+			return iRV ;
+		}
+		Status = Burst[ds2482POLL_BURST - 1] ;			// latest, once 1WB clears it stays clear
+		ds2482STAT_ADD(BusyPolls, ds2482POLL_BURST) ;
+	}
+	if (Status & STATUS_1WB) {
+		return ds2482WaitNotBusy(0) ;					// slow device/bus, yield between polls
+	}
+	sDS2482.Regs.Rstat	= Status ;
+	return erSUCCESS ;
+}
+
+/**
+ * ds2482XactWriteByte() - write a byte to the 1-Wire bus and wait till done
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	ds2482XactWriteByte(uint8_t Byte) {
+	ds2482STAT_START(Start) ;
+	uint8_t	cBuf[2] = { CMD_1WWB, Byte } ;
+	int32_t iRV = ds2482XactCommand(cBuf, sizeof(cBuf)) ;
+	ds2482STAT_STOP(ds2482OP_WRBYTE, Start) ;
+	return iRV ;
+}
+
+/**
+ * ds2482XactReadByte() - read a byte from the 1-Wire bus
+ * @return	byte read (0->255) or erFAILURE
+ */
+int32_t	ds2482XactReadByte(void) {
+// 1-Wire Read Byte (Case C) with fused SRP & read
+//	S AD,0 [A] 1WRB [A] Sr AD,1 [A] [Status] A [Status] A\ P
+//	S AD,0 [A] SRP [A] E1 [A] Sr AD,1 [A] DD A\ P
+	ds2482STAT_START(Start) ;
+	uint8_t	cBuf[2] = { CMD_1WRB, 0 } ;
+	int32_t iRV = ds2482XactCommand(cBuf, 1) ;
+	if (iRV == erSUCCESS) {
+		cBuf[0] = CMD_SRP ;
+		cBuf[1] = ((~ds2482REG_DATA & 0x0F) << 4) | ds2482REG_DATA ;	// 0xE1
+		uint8_t	cRead ;
+		iRV = ds2482I2C_WriteRead(cBuf, sizeof(cBuf), &cRead, sizeof(cRead)) ;
+		IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+		if (iRV == erSUCCESS) {
+			sDS2482.RegPntr		= ds2482REG_DATA ;
+			sDS2482.PntrValid	= 1 ;
+			sDS2482.Regs.Rdata	= cRead ;
+			iRV = cRead ;
+		} else {
+			sDS2482.PntrValid = 0 ;
+		}
+	}
+	ds2482STAT_STOP(ds2482OP_RDBYTE, Start) ;			// failures are timed as well
+	return iRV ;
+}
+
 /**
  * Use the DS2482 help command '1-Wire triplet' to perform one bit of a 1-Wire
  * search. This command does two read bits and one write bit. The write bit
  * is either the default direction (all device have same bit) or in case of
  * a discrepancy, the 'search_direction' parameter is used.
  *
- * Returns  The DS2482 status byte result from the triplet command
+ * Returns  The DS2482 status byte result from the triplet command or erFAILURE
  */
-uint8_t ds2482SearchTriplet(uint8_t search_direction) {
+int32_t	ds2482SearchTriplet(uint8_t search_direction) {
 // 1-Wire Triplet (Case B)
 //	S AD,0 [A] 1WT [A] SS [A] Sr AD,1 [A] [Status] A [Status] A\ P
 //							  \--------/
@@ -264,12 +611,18 @@ uint8_t ds2482SearchTriplet(uint8_t search_direction) {
 //  [] indicates from slave
 //  SS indicates byte containing search direction bit value in msbit
 	IF_myASSERT(debugPARAM, search_direction < 2) ;
+	ds2482STAT_START(Start) ;
 	uint8_t	cBuf[2] = { CMD_1WT, search_direction ? 0x80 : 0x00 } ;
-	if (ds2482WriteAndWait(cBuf, sizeof(cBuf), owDELAY_ST) == erFAILURE) {
-		ds2482Reset();
-		return 0;
+	int32_t	iRV = ds2482WriteAndWait(cBuf, sizeof(cBuf), owDELAY_ST) ;
+	if (iRV != erSUCCESS) {
+		ds2482HealthUpdate(sDS2482.CurChan, 0) ;
+		ds2482Recover() ;								// caller restarts the search pass
+		iRV = erFAILURE ;
+	} else {
+		iRV = sDS2482.Regs.Rstat ;
 	}
-	return sDS2482.Regs.Rstat ;
+	ds2482STAT_STOP(ds2482OP_TRIPLET, Start) ;
+	return iRV ;
 }
 
 /**
@@ -295,6 +648,11 @@ int32_t ds2482Detect(void) {
 	sDS2482.Regs.RES1	= 0 ;							// MSBit
 	// confirm bit packing order is correct
 	IF_myASSERT(debugCONFIG, sDS2482.Regs.Rconf == CONFIG_APU) ;
+#if		(halHAS_DS2484 == 1 && ds2484PROFILE != ds2484PROF_DEFAULT)
+	if (ds2484PortProfile(ds2484PROFILE) != erSUCCESS) {
+		return 0 ;
+	}
+#endif
 	return ds2482WriteConfig() ;
 }
 
@@ -304,19 +662,23 @@ int32_t ds2482Detect(void) {
  * Read a register based on last/current Read Pointer status
  */
 uint8_t	ds2482ReadRegister(uint8_t Reg) {
-	IF_myASSERT(debugPARAM, Reg < ds2482REG_NUM)
-	int32_t	iRV = halI2C_Read(&sDS2482.sI2Cdev, (uint8_t *) &sDS2482.Regs.RegX[Reg], sizeof(uint8_t)) ;
+	IF_myASSERT(debugPARAM, Reg < ds2482REG_NUM) ;
+	int32_t	iRV = ds2482I2C_Read((uint8_t *) &sDS2482.Regs.RegX[Reg], sizeof(uint8_t)) ;
 	if (iRV != erSUCCESS) {
 		return 0 ;
 	}
+	if (Reg == ds2482REG_CONF && sDS2482.PntrValid && sDS2482.RegPntr == ds2482REG_CONF) {
+		sDS2482.ConfLast	= sDS2482.Regs.Rconf & 0x0F ;	// resync with the device
+		sDS2482.ConfValid	= 1 ;
+	}
 	return 1 ;
 }
 
 /**
  * ds2482PrintROM() - print the 1-Wire ROM information
- * @param psOW_ROM
+ * @param sROM		by value, ROMs are mostly members of packed structures
  */
-void	ds2482PrintROM(ow_rom_t * psOW_ROM) { PRINT("%02X/%M/%02X\n", psOW_ROM->Family, psOW_ROM->TagNum, psOW_ROM->CRC) ; }
+void	ds2482PrintROM(ow_rom_t sROM) { PRINT("%02X/%M/%02X\n", sROM.Family, sROM.TagNum, sROM.CRC) ; }
 
 /**
  * Display register contents
@@ -345,25 +707,38 @@ void	ds2482PrintRegisters(void) {
 			sDS2482.Regs.OWS	? '1' : '0',
 			sDS2482.Regs.SPU	? '1' : '0',
 			sDS2482.Regs.APU	? '1' : '0') ;
+#if		(halHAS_DS2484 == 1)
+	PRINT("PCFG(4)=%-'+b  Profile=%d\n", sizeof(ds2484PortCfg), ds2484PortCfg, ds2484Profile) ;
+#endif
 }
 
 /**
  * Read ALL the registers
  */
 uint8_t	ds2482ReadRegisters(void) {
-	for (uint8_t Reg = ds2482REG_STAT; Reg < ds2482REG_NUM; ++Reg) {
-		ds2482SetReadPointer(Reg) ;
-		if (ds2482ReadRegister(Reg) == 0) {
+	for (uint8_t Idx = 0; Idx < sizeof(ds2482RegMap); ++Idx) {
+		ds2482SetReadPointer(ds2482RegMap[Idx]) ;
+		if (ds2482ReadRegister(ds2482RegMap[Idx]) == 0) {
 			return 0 ;
 		}
 	}
+#if		(halHAS_DS2484 == 1)
+	ds2482SetReadPointer(ds2484REG_PCFG) ;
+	if (ds2482I2C_Read(ds2484PortCfg, sizeof(ds2484PortCfg)) != erSUCCESS) {
+		return 0 ;
+	}
+#endif
 	return 1 ;
 }
 
 uint8_t	ds2482Report(void) {
+	if (ds2482Lock(sDS2482.CurChan) != erSUCCESS) {
+		return 0 ;
+	}
 	if (ds2482ReadRegisters() == 1) {
 		ds2482PrintRegisters() ;
 	}
+	ds2482Unlock() ;
 	return 1 ;
 }
 
@@ -380,7 +755,7 @@ uint8_t	ds2482Report(void) {
  * Returns: 0:	0 bit read from sendbit
  *			 1:	1 bit read from sendbit
  */
-uint8_t OWTouchBit(uint8_t sendbit) {
+static uint8_t ds2482OWTouchBit(uint8_t sendbit) {
 // 1-Wire bit (Case B)
 //	S AD,0 [A] 1WSB [A] BB [A] Sr AD,1 [A] [Status] A [Status] A\ P
 //										   \--------/
@@ -400,29 +775,13 @@ uint8_t OWTouchBit(uint8_t sendbit) {
 }
 
 /**
- * Send 1 bit of communication to the 1-Wire Net.
- * The parameter 'sendbit' least significant bit is used.
- *
- * 'sendbit' - 1 bit to send (least significant byte)
- */
-void	OWWriteBit(uint8_t sendbit) { OWTouchBit(sendbit); }
-
-/**
- * Read 1 bit of communication from the 1-Wire Net and return the result
- *
- * Returns:  1 bit read from 1-Wire Net
- */
-uint8_t OWReadBit(void) { return OWTouchBit(0x01) ; }
-
-/**
- * Send 8 bits of communication to the 1-Wire Net and verify that the
- * 8 bits read from the 1-Wire Net is the same (write operation).
+ * Start sending 8 bits of communication to the 1-Wire Net, does NOT wait for completion.
  * The parameter 'sendbyte' least significant 8 bits are used.
  *
  * 'sendbyte' - 8 bits to send (least significant byte)
  * @return	erSUCCESS or erFAILURE
  */
-int32_t	OWWriteByte(uint8_t sendbyte) {
+static int32_t	ds2482OWWriteByte(uint8_t sendbyte) {
 // 1-Wire Write Byte (Case B)
 //	S AD,0 [A] 1WWB [A] DD [A] Sr AD,1 [A] [Status] A [Status] A\ P
 //										   \--------/
@@ -436,10 +795,12 @@ int32_t	OWWriteByte(uint8_t sendbyte) {
 }
 
 int32_t	OWWriteByteWait(uint8_t sendbyte) {
-	int32_t iRV = OWWriteByte(sendbyte) ;
+	ds2482STAT_START(Start) ;
+	int32_t iRV = ds2482OWWriteByte(sendbyte) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
 	iRV = ds2482WaitNotBusy(owDELAY_WB) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS) ;
+	ds2482STAT_STOP(ds2482OP_WRBYTE, Start) ;
 	return iRV ;
 }
 
@@ -460,7 +821,7 @@ int32_t OWWriteBytePower(int32_t sendbyte) {
 		IF_myASSERT(debugRESULT, 0) ;
 		return 0 ;
 	}
-	int32_t iRV = OWWriteByte(sendbyte) ;
+	int32_t iRV = ds2482OWWriteByte(sendbyte) ;
 	IF_myASSERT(debugRESULT, iRV == erSUCCESS && sDS2482.Regs.SPU == 1) ;
 	return 1 ;
 }
@@ -482,7 +843,7 @@ int32_t OWReadBitPower(int32_t applyPowerResponse) {
 	if (ds2482WriteConfig() == 0) {
 		return 0 ;
 	}
-	uint8_t rdbit = OWReadBit();
+	uint8_t rdbit = ds2482OWTouchBit(0x01) ;
 	if (rdbit != applyPowerResponse) {					// check if response was correct
 		OWLevel(owMODE_STANDARD);						// if not, turn off strong pull-up
 		return 0 ;
@@ -490,68 +851,6 @@ int32_t OWReadBitPower(int32_t applyPowerResponse) {
 	return 1 ;
 }
 
-/**
- * Send 8 bits of read communication to the 1-Wire Net and return the
- * result 8 bits read from the 1-Wire Net.
- *
- * Returns:  8 bits read from 1-Wire Net
- */
-int32_t	OWReadByte(void) {
-/* 1-Wire Read Bytes (Case C)
- *	S AD,0 [A] 1WRB [A] Sr AD,1 [A] [Status] A [Status] A\
- *										\--------/
- *							Repeat until 1WB bit has changed to 0
- *	Sr AD,0 [A] SRP [A] E1 [A] Sr AD,1 [A] DD A\ P
- *
- *  [] indicates from slave
- *  DD data read
- */
-	int32_t iRV = OWWriteByteWait(CMD_1WRB) ;			// send the READ command
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
-	iRV = ds2482SetReadPointer(ds2482REG_DATA) ;		// set pointer to data register
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-
-	uint8_t	cRead ;
-	iRV = halI2C_Read(&sDS2482.sI2Cdev, &cRead, sizeof(cRead)) ;			// read the register
-	IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
-	return cRead ;
-}
-
-/**
- * Send 8 bits of communication to the 1-Wire Net and return the
- * result 8 bits read from the 1-Wire Net.  The parameter 'sendbyte'
- * least significant 8 bits are used and the least significant 8 bits
- * of the result is the return byte.
- *
- * 'sendbyte' - 8 bits to send (least significant byte)
- *
- * Returns:  8 bits read from sendbyte
- */
-uint8_t OWTouchByte(uint8_t sendbyte) {
-	if (sendbyte == 0xFF) {
-		return OWReadByte();
-	} else {
-		OWWriteByteWait(sendbyte);
-		return sendbyte;
-	}
-}
-
-/**
- * The 'OWBlock' transfers a block of data to and from the
- * 1-Wire Net. The result is returned in the same buffer.
- *
- * 'tran_buf' - pointer to a block of unsigned
- *				  chars of length 'tran_len' that will be sent
- *				  to the 1-Wire Net
- * 'tran_len' - length in bytes to transfer
- */
-void	OWBlock(uint8_t * tran_buf, int32_t tran_len) {
-	for (int32_t i = 0; i < tran_len; ++i) {
-		tran_buf[i] = OWTouchByte(tran_buf[i]) ;
-	}
-}
-
 /**
  * OWReadROM() - Check PPD, send command and loop for 8byte read
  * @brief	To be used if only a single device on a bus and the ROM ID must be read
@@ -559,19 +858,22 @@ void	OWBlock(uint8_t * tran_buf, int32_t tran_len) {
  * @return	erFAILURE or CRC byte
  */
 int32_t	OWReadROM(void) {
-	int32_t iRV = OWWriteByteWait(OW_CMD_READROM) ;
-	LT_GOTO(iRV, erSUCCESS, exit) ;
-
-	sDS2482.ROM.Value = 0ULL ;
+	int32_t iRV ;
+	ow_retry_t sRetry ;
+	ow_xact_t	sXact = {									// read 8x bytes making up the ROM FAM+ID+CRC
+		.Flags = owXACT_CRC8, .Cmd = OW_CMD_READROM,
+		.RxLen = ONEWIRE_ROM_LENGTH, .pRx = sDS2482.ROM.HexChars,
+	} ;
+	OWRetryStart(&sRetry, owOP_READROM, sDS2482.CurChan) ;
 	do {
-		for (uint8_t i = 0; i < ONEWIRE_ROM_LENGTH; ++i) {
-			iRV = OWReadByte() ;							// read 8x bytes making up the ROM FAM+ID+CRC
-			LT_GOTO(iRV, erSUCCESS, exit) ;
-			sDS2482.ROM.HexChars[i] = iRV ;
+		iRV = OWXactRun(&sXact) ;
+		LT_RETURN(iRV, erSUCCESS) ;						// bridge failure
+		if (iRV == 1) {
+			return sDS2482.ROM.CRC ;
 		}
-	} while (OWCheckCRC(sDS2482.ROM.HexChars, ONEWIRE_ROM_LENGTH) == 0) ;
-exit:
-	return iRV ;
+		sXact.Flags |= owXACT_RESET ;					// retry needs a new reset & command
+	} while (OWRetryNext(&sRetry)) ;
+	return erFAILURE ;
 }
 
 // ################################ Generic 1-Wire LINK API's ######################################
@@ -596,6 +898,9 @@ uint8_t	OWCheckCRC(uint8_t * buf, uint8_t buflen) {
 		}
 	}
 	IF_PRINT(debugCRC && shift_reg, "CRC=%x FAIL %'-+b\n", shift_reg, buflen, buf) ;
+	if (shift_reg) {
+		ds2482STAT_INC(CRCfail) ;
+	}
 	return (shift_reg == 0) ? 1 : 0 ;
 }
 
@@ -605,35 +910,75 @@ uint8_t	OWCheckCRC(uint8_t * buf, uint8_t buflen) {
  * @param	data
  * @return				Returns current crc8 value
  */
-uint8_t	OWCalcCRC8(uint8_t data) {
-	sDS2482.crc8 = sDS2482.crc8 ^ data;
+static uint8_t	OWCrc8(uint8_t crc8, uint8_t data) {
+	crc8 = crc8 ^ data;
 	for (int32_t i = 0; i < BITS_IN_BYTE; ++i) {
-		if (sDS2482.crc8 & 1) {
-			sDS2482.crc8 = (sDS2482.crc8 >> 1) ^ 0x8c;
+		if (crc8 & 1) {
+			crc8 = (crc8 >> 1) ^ 0x8c;
 		} else {
-			sDS2482.crc8 = (sDS2482.crc8 >> 1);
+			crc8 = (crc8 >> 1);
 		}
 	}
+	return crc8;
+}
+
+uint8_t	OWCalcCRC8(uint8_t data) {
+	sDS2482.crc8 = OWCrc8(sDS2482.crc8, data) ;
 	return sDS2482.crc8;
 }
 
 /**
- * Reset all of the devices on the 1-Wire Net and return the result.
+ * OWCalcCRC16() - accumulate the CRC16 (x^16 + x^15 + x^2 + 1) over a buffer
+ * @brief	See Application Note 27. Devices send the inverted CRC, LSB first
+ * @return	updated crc16 value
+ */
+uint16_t OWCalcCRC16(uint16_t crc16, const uint8_t * pBuf, size_t Len) {
+	while (Len--) {
+		crc16 ^= *pBuf++ ;
+		for (int32_t i = 0; i < BITS_IN_BYTE; ++i) {
+			crc16 = (crc16 & 1) ? (crc16 >> 1) ^ 0xA001 : (crc16 >> 1) ;
+		}
+	}
+	return crc16 ;
+}
+
+/**
+ * Reset all of the devices on the selected channel and return the result.
  *
  * Returns: true(1):  presence pulse(s) detected, device(s) reset
  *			 false(0): no presence pulses detected
  */
-int32_t OWReset(void) {
+int32_t ds2482OWReset(void) {
 // 1-Wire reset (Case B)
 //	S AD,0 [A] 1WRS [A] Sr AD,1 [A] [Status] A [Status] A\ P
 //									\--------/
 //						Repeat until 1WB bit has changed to 0
 //  [] indicates from slave
 	IF_myASSERT(debugBUS_CFG, sDS2482.Regs.OWB == 0 && sDS2482.Regs.SPU == 0) ;
+	IF_myASSERT(debugLOCK, xSemaphoreGetMutexHolder(sDS2482.Mux) == xTaskGetCurrentTaskHandle()) ;
+	ds2482STAT_START(Start) ;
 	uint8_t	cChr = CMD_1WRS ;
-	if (ds2482WriteAndWait(&cChr, sizeof(cChr), owDELAY_RST) == erFAILURE) {
-		ds2482Reset();
-		return 0;
+	uint8_t	Chan = sDS2482.CurChan ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_RESET, Chan) ;
+	while (ds2482WriteAndWait(&cChr, sizeof(cChr), owDELAY_RST) == erFAILURE) {
+		ds2482HealthUpdate(Chan, 0) ;
+		ds2482Recover() ;								// back on Chan with the same config
+		if (OWRetryNext(&sRetry) == 0) {
+			ds2482STAT_STOP(ds2482OP_RESET, Start) ;
+			return 0 ;
+		}
+	}
+	ds2482STAT_STOP(ds2482OP_RESET, Start) ;
+	ds2482HealthShort(sDS2482.CurChan, sDS2482.Regs.SD) ;
+	if (sDS2482.Regs.SD) {								// short, no point in continuing
+		return 0 ;
+	}
+	if (sDS2482Health[sDS2482.CurChan].Probing) {		// electrically OK, release
+		ds2482HealthUpdate(sDS2482.CurChan, 1) ;
+	}
+	if (sDS2482.Regs.PPD == 0) {
+		ds2482STAT_INC(NoPresence) ;
 	}
 	return sDS2482.Regs.PPD ;
 }
@@ -684,14 +1029,14 @@ int32_t OWLevel(int32_t new_level) {
 void	OWAddress(uint8_t nAddrMethod) {
 	int32_t iRV ;
 	if (nAddrMethod == OW_CMD_MATCHROM) {
-		iRV = OWWriteByteWait(OW_CMD_MATCHROM) ;		// address single/individual device
+		iRV = ds2482XactWriteByte(OW_CMD_MATCHROM) ;	// address single/individual device
 		IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
 		for (uint8_t i = 0; i < ONEWIRE_ROM_LENGTH; ++i) {
-			iRV = OWWriteByteWait(sDS2482.ROM.HexChars[i]);
+			iRV = ds2482XactWriteByte(sDS2482.ROM.HexChars[i]);
 			IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
 		}
 	} else {
-		iRV = OWWriteByteWait(OW_CMD_SKIPROM) ;			// address all devices
+		iRV = ds2482XactWriteByte(OW_CMD_SKIPROM) ;		// address all devices
 		IF_myASSERT(debugRESULT, iRV > erFAILURE) ;
 	}
 }
@@ -709,21 +1054,46 @@ void	OWAddress(uint8_t nAddrMethod) {
  * Using the find alarm command 0xEC will limit the search to only
  * 1-Wire devices that are in an 'alarm' state.
  *
+ * The search state lives in the caller's context, the bridge is only locked for the
+ * duration of one pass (reset .. 64th triplet) so other tasks can interleave between
+ * devices without disturbing the search.
+ *
  * Returns:	true (1) : when a 1-Wire device was found and its
- *						  Serial Number placed in the global ROM
+ *						  Serial Number placed in psS->ROM
  *			false (0): when no new device was found.  Either the
  *						  last search was the last device or there
  *						  are no devices on the 1-Wire Net.
+ *			erFAILURE: the ROM could not be read (triplet or CRC failure,
+ *						  device lost part way), retries exhausted.
  */
-int32_t OWSearch(void) {
-	int32_t	id_bit_number = 1, last_zero = 0, rom_byte_number = 0, search_result = 0;
-	uint8_t	rom_byte_mask = 1;
-	sDS2482.crc8 = 0;
-	if (sDS2482.LastDeviceFlag == 0) {					// if the last call was not the last device
-		if (OWReset() == 0) {							// reset the search
-			sDS2482.LastDiscrepancy			= 0 ;
-			sDS2482.LastDeviceFlag			= 0 ;
-			sDS2482.LastFamilyDiscrepancy	= 0 ;
+int32_t ds2482OWSearchNext(ow_search_t * psS) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psS)) ;
+	ds2482STAT_START(Start) ;
+	int32_t	id_bit_number, last_zero, rom_byte_number, search_result = 0, failed = 0 ;
+	int32_t	lfd_backup = psS->LastFamilyDiscrepancy ;
+	uint8_t	rom_byte_mask ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_SEARCH, psS->Chan) ;
+	if (ds2482Lock(psS->Chan) != erSUCCESS) {
+		ds2482STAT_STOP(ds2482OP_SEARCH, Start) ;
+		return erFAILURE ;
+	}
+	if (psS->LastDeviceFlag == 0) {					// if the last call was not the last device
+	/* The search state is only updated once a pass completes, and ROM bits beyond LastDiscrepancy
+	 * are never read, so a pass that failed part way can simply be restarted from here */
+retry:
+		id_bit_number = 1 ;
+		last_zero = 0 ;
+		rom_byte_number = 0 ;
+		rom_byte_mask = 1 ;
+		psS->crc8 = 0 ;
+		failed = 0 ;
+		psS->LastFamilyDiscrepancy = lfd_backup ;
+		if (ds2482OWReset() == 0) {						// reset the search
+			psS->LastDiscrepancy			= 0 ;
+			psS->LastDeviceFlag			= 0 ;
+			psS->LastFamilyDiscrepancy	= 0 ;
+			ds2482Unlock() ;
 			return 0;
 		}
 		OWWriteByteWait(OW_CMD_SEARCHROM) ;				// search for device
@@ -731,43 +1101,51 @@ int32_t OWSearch(void) {
 		do {											// loop to do the search
 		// if this discrepancy is before the Last Discrepancy
 		// on a previous next then pick the same as last time
-			if (id_bit_number < sDS2482.LastDiscrepancy) {
-				if ((sDS2482.ROM.HexChars[rom_byte_number] & rom_byte_mask) > 0) {
+			if (id_bit_number < psS->LastDiscrepancy) {
+				if ((psS->ROM.HexChars[rom_byte_number] & rom_byte_mask) > 0) {
 					search_direction = 1 ;
 				} else {
 					search_direction = 0 ;
 				}
 			} else {									// if equal to last pick 1, if not then pick 0
-				if (id_bit_number == sDS2482.LastDiscrepancy) {
+				if (id_bit_number == psS->LastDiscrepancy) {
 					search_direction = 1 ;
 				} else {
 					search_direction = 0 ;
 				}
 			}
 		// Perform a triple operation on the DS2482 which will perform 2 read bits and 1 write bit
-			uint8_t status = ds2482SearchTriplet(search_direction) ;
+			int32_t status = ds2482SearchTriplet(search_direction) ;
+			if (status == erFAILURE) {
+				if (OWRetryNext(&sRetry)) {
+					goto retry ;
+				}
+				failed = 1 ;
+				break ;									// id_bit_number < 65 so search fails
+			}
 		// check bit results in status byte
 			int32_t	id_bit		= ((status & STATUS_SBR) == STATUS_SBR) ;
 			int32_t	cmp_id_bit	= ((status & STATUS_TSB) == STATUS_TSB) ;
 			search_direction	= ((status & STATUS_DIR) == STATUS_DIR) ? 1 : 0 ;
 			if ((id_bit) && (cmp_id_bit)) {				// check for no devices on 1-Wire
+				failed = (id_bit_number > 1) ;			// device(s) lost part way
 				break ;
 			} else {
 				if ((!id_bit) && (!cmp_id_bit) && (search_direction == 0)) {
 					last_zero = id_bit_number ;
 					if (last_zero < 9) {				// check for Last discrepancy in family
-						sDS2482.LastFamilyDiscrepancy = last_zero ;
+						psS->LastFamilyDiscrepancy = last_zero ;
 					}
 				}
 				if (search_direction == 1) {			// set or clear the bit in the ROM byte rom_byte_number with mask rom_byte_mask
-					sDS2482.ROM.HexChars[rom_byte_number] |= rom_byte_mask ;
+					psS->ROM.HexChars[rom_byte_number] |= rom_byte_mask ;
 				} else {
-					sDS2482.ROM.HexChars[rom_byte_number] &= ~rom_byte_mask ;
+					psS->ROM.HexChars[rom_byte_number] &= ~rom_byte_mask ;
 				}
 				++id_bit_number ;						// increment the byte counter id_bit_number & shift the mask rom_byte_mask
 				rom_byte_mask <<= 1 ;
 				if (rom_byte_mask == 0) {				// if the mask is 0 then go to new SerialNum byte rom_byte_number and reset mask
-					OWCalcCRC8(sDS2482.ROM.HexChars[rom_byte_number]);  // accumulate the CRC
+					psS->crc8 = OWCrc8(psS->crc8, psS->ROM.HexChars[rom_byte_number]) ;  // accumulate the CRC
 					++rom_byte_number ;
 					rom_byte_mask = 1 ;
 				}
@@ -775,25 +1153,58 @@ int32_t OWSearch(void) {
 		} while(rom_byte_number < ONEWIRE_ROM_LENGTH) ;  // loop until all
 
 	// if the search was successful then
-		if (!((id_bit_number < 65) || (sDS2482.crc8 != 0))) {
-			sDS2482.LastDiscrepancy = last_zero;		// search successful, set LastDiscrepancy,LastDeviceFlag,search_result
-			if (sDS2482.LastDiscrepancy == 0) {			// check for last device
-				sDS2482.LastDeviceFlag	= 1 ;
+		if (!((id_bit_number < 65) || (psS->crc8 != 0))) {
+			psS->LastDiscrepancy = last_zero;		// search successful, set LastDiscrepancy,LastDeviceFlag,search_result
+			if (psS->LastDiscrepancy == 0) {			// check for last device
+				psS->LastDeviceFlag	= 1 ;
 			}
 			search_result = 1 ;
+		} else if (id_bit_number == 65 && OWRetryNext(&sRetry)) {
+			goto retry ;								// CRC error, read the ROM again
+		} else if (id_bit_number == 65) {
+			failed = 1 ;
 		}
 	}
 
 	// if no device found then reset counters so next 'search' will be like a first
-	if (!search_result || (sDS2482.ROM.Family == 0)) {
-		sDS2482.LastDiscrepancy	= 0 ;
-		sDS2482.LastDeviceFlag	= 0 ;
-		sDS2482.LastFamilyDiscrepancy = 0 ;
-		search_result = 0 ;
+	if (!search_result || (psS->ROM.Family == 0)) {
+		failed |= search_result ;						// all 0's, bus held low
+		psS->LastDiscrepancy	= 0 ;
+		psS->LastDeviceFlag	= 0 ;
+		psS->LastFamilyDiscrepancy = 0 ;
+		search_result = failed ? erFAILURE : 0 ;
 	}
+	ds2482Unlock() ;
+	ds2482STAT_STOP(ds2482OP_SEARCH, Start) ;
 	return search_result;
 }
 
+/* Legacy search API, state kept in sDS2482 for callers such as OWVerify() and the
+ * handlers that read sDS2482.ROM. Only safe with the bridge held by the caller. */
+
+static void	OWSearchLoad(ow_search_t * psS) {
+	memcpy(&psS->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
+	psS->LastDiscrepancy		= sDS2482.LastDiscrepancy ;
+	psS->LastFamilyDiscrepancy	= sDS2482.LastFamilyDiscrepancy ;
+	psS->LastDeviceFlag			= sDS2482.LastDeviceFlag ;
+	psS->Chan					= sDS2482.CurChan ;
+}
+
+static void	OWSearchSave(ow_search_t * psS) {
+	memcpy(&sDS2482.ROM, &psS->ROM, sizeof(ow_rom_t)) ;
+	sDS2482.LastDiscrepancy			= psS->LastDiscrepancy ;
+	sDS2482.LastFamilyDiscrepancy	= psS->LastFamilyDiscrepancy ;
+	sDS2482.LastDeviceFlag			= psS->LastDeviceFlag ;
+}
+
+int32_t OWSearch(void) {
+	ow_search_t	sS ;
+	OWSearchLoad(&sS) ;
+	int32_t	iRV = ds2482OWSearchNext(&sS) ;
+	OWSearchSave(&sS) ;
+	return iRV ;
+}
+
 /**
  * Find the 'first' device on the 1W network
  * Return true  : device found, ROM number in ROM.Number buffer
@@ -870,6 +1281,34 @@ void	OWFamilySkipSetup(void) {
 	}
 }
 
+// ############################# 1-Wire transport (owbus.h) interface #############################
+
+/* Bytes go through the fused primitives, a block has no bridge support so 0xFF is read and
+ * anything else written, which matches what every caller of OWBlock() needs. */
+
+static int32_t	ds2482BusBlock(uint8_t * pBuf, int32_t Len) {
+	for (int32_t i = 0; i < Len; ++i) {
+		int32_t	iRV = (pBuf[i] == 0xFF) ? ds2482XactReadByte() : ds2482XactWriteByte(pBuf[i]) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+		if (pBuf[i] == 0xFF) {
+			pBuf[i] = iRV ;
+		}
+	}
+	return Len ;
+}
+
+const ow_bus_t	ds2482Bus = {
+	.pName		= "DS2482",
+	.Lock		= ds2482Lock,
+	.Unlock		= ds2482Unlock,
+	.Reset		= ds2482OWReset,
+	.TouchBit	= ds2482OWTouchBit,
+	.WriteByte	= ds2482XactWriteByte,
+	.ReadByte	= ds2482XactReadByte,
+	.Block		= ds2482BusBlock,
+	.Search		= ds2482OWSearchNext,
+} ;
+
 // ################################# Application support functions #################################
 
 /**
@@ -877,25 +1316,7 @@ void	OWFamilySkipSetup(void) {
  * @return	return value from handler or
  */
 int32_t	ds2482HandleFamilies(int32_t iCount, void * pVoid) {
-	int32_t	iRV = erFAILURE ;
-	switch (sDS2482.ROM.Family) {
-#if		(halHAS_DS1990X == 1)
-	case OWFAMILY_01:							// DS1990A/R, 2401/11 devices
-		iRV = ds1990xHandleRead(iCount, pVoid) ;
-		break ;
-#endif
-
-#if		(halHAS_DS18X20 == 1)
-	case OWFAMILY_10:							// DS18S20 Thermometer
-	case OWFAMILY_28:							// DS18B20 Thermometer
-		iRV = ds18x20Handler(iCount, pVoid) ;
-		break ;
-#endif
-
-	default:
-		SL_ERR("Invalid OW device FAM=%02x", sDS2482.ROM.Family) ;
-	}
-	return iRV ;
+	return OWFamilyHandle(sDS2482.ROM.Family, iCount, pVoid) ;
 }
 
 /**
@@ -927,21 +1348,27 @@ int32_t	ds2482ScanChannel(uint8_t Family, int32_t (* Handler)(int32_t, void *),
 	return iRV < erSUCCESS ? iRV : iCount ;
 #else
 	int32_t	iCount = 0 ;
-	OWTargetSetup(Family) ;
-	int32_t	iRV = OWSearch() ;
-	while (iRV == 1) {
-		iRV = OWCheckCRC(sDS2482.ROM.HexChars, sizeof(ow_rom_t)) ;
-		myASSERT(iRV == 1) ;
-		if (Family == 0 || Family == sDS2482.ROM.Family) {
-			if (Handler) {
+	ow_search_t	sS ;
+	OWSearchInit(&sS, sDS2482.CurChan, Family) ;
+	int32_t	iRV = ds2482OWSearchNext(&sS) ;
+	while (iRV == 1) {									// ROM CRC checked by the search
+		ds2482HealthUpdate(sS.Chan, 1) ;
+		if ((Family == 0 || Family == sS.ROM.Family) && ds2409Wanted(sS.ROM, sS.Chan)) {
+			if (Handler) {								// handlers expect the ROM in sDS2482
+				memcpy(&sDS2482.ROM, &sS.ROM, sizeof(ow_rom_t)) ;
 				iRV = Handler(xCount + iCount, pVoid) ;
-				LT_BREAK(iRV, erSUCCESS) ;
+				LT_RETURN(iRV, erSUCCESS) ;
 			}
 			++iCount ;
 		}
-		iRV = OWNext() ;								// try to find next device (if any)
+		iRV = ds2482OWSearchNext(&sS) ;					// try to find next device (if any)
 	}
-	return iRV < erSUCCESS ? iRV : iCount ;
+	if (iRV == erFAILURE) {								// not the same as no (more) devices
+		ds2482HealthUpdate(sS.Chan, 0) ;
+		OWEventPost(owEVT_READERR, sS.Chan, sS.ROM, owACCESS_NONE) ;
+		return erFAILURE ;
+	}
+	return iCount ;
 #endif
 }
 
@@ -951,17 +1378,36 @@ int32_t	ds2482ScanChannel(uint8_t Family, int32_t (* Handler)(int32_t, void *),
  */
 int32_t	ds2482ScanAllChannels(uint8_t Family, int (* Handler)(int32_t, void *), void * pVoid) {
 	int32_t	iRV = erSUCCESS, xCount = 0 ;
-	xRtosSemaphoreTake(&sDS2482.Mux, portMAX_DELAY) ;
+	ds2482ArbAcquire(Family == OWFAMILY_01 ? ds2482PRIO_IBUTTON : ds2482PRIO_ENUM) ;
 	for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		if (Chan) {
+			ds2482ArbYield() ;							// channel done, let higher class in
+		}
+		if (ds2482HealthUsable(Chan) == 0) {			// quarantined, skip
+			continue ;
+		}
 #if		(halHAS_DS2482_800 == 1)
 		iRV = ds2482ChannelSelect(Chan) ;
 		LT_BREAK(iRV, erSUCCESS) ;
+#endif
+#if		(halHAS_DS2409 == 1)
+		ds2409AllOff(Chan) ;							// trunk pass, elided if all off already
 #endif
 		iRV = ds2482ScanChannel(Family, Handler, xCount, pVoid) ;
 		LT_BREAK(iRV, erSUCCESS) ;						// if callback failed, return
+#if		(halHAS_DS1990X == 1)
+		if (Family == OWFAMILY_01 && iRV == 0) {		// no iButton on this channel (anymore)
+			ds1990xHandleDepart(Chan) ;
+		}
+#endif
 		xCount += iRV ;									// update running count
+#if		(halHAS_DS2409 == 1)
+		iRV = ds2409ScanBranches(Chan, Family, Handler, xCount, pVoid) ;
+		LT_BREAK(iRV, erSUCCESS) ;
+		xCount += iRV ;
+#endif
 	}
-	xRtosSemaphoreGive(&sDS2482.Mux) ;
+	ds2482ArbRelease() ;
 	IF_SL_ERR(iRV < erSUCCESS, "iRV=%d", iRV) ;
 	return iRV < erSUCCESS ? iRV : xCount ;
 }
@@ -982,21 +1428,27 @@ int32_t	ds2482Diagnostics(void) {
 	if (ds2482Report() == 0) {
 		return erFAILURE ;
 	}
+	ds2482StatsReport() ;
+	ds2482HealthReport() ;
+	ds2482ArbReport() ;
+	OWFamilyReport() ;
+#if		(halHAS_DS2409 == 1)
+	ds2409Report() ;
+#endif
 	return erSUCCESS ;
 }
 
 /**
  * DS2482CountDevices() - Scan all buses and count/list all devices on all channels
- * @param pDS24282	pointer to device structure
+ * @brief			Each channel is scanned under the bridge lock
  * @return			number of devices found
  */
 int32_t	ds2482CountDevices(void) {
 	int32_t	iRV, iCount = 0 ;
 	for (int32_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
-#if		(halHAS_DS2482_800 == 1)
-		iRV = ds2482ChannelSelect(Chan) ;
-		EQ_RETURN(iRV, erFAILURE) ;
-#endif
+		if (ds2482Lock(Chan) != erSUCCESS) {			// and select the channel
+			return erFAILURE ;
+		}
 
 #if		(ds18x20PWR_SOURCE == 1)
 		xActuatorBlock(Chan) ;
@@ -1005,32 +1457,25 @@ int32_t	ds2482CountDevices(void) {
 		int32_t	PwrFlag = 0 ;
 #endif
 
-		iRV = OWFirst() ;
-		while (iRV == 1) {
-			switch (sDS2482.ROM.Family) {
-#if		(halHAS_DS1990X == 1)
-			case OWFAMILY_01:							// DS1990A/R, 2401/11 devices
-				++Family01Count ;						// count ONLY for sake of reporting
-				break ;
+#if		(halHAS_DS2409 == 1)
+		ds2409AllOff(Chan) ;							// trunk devices only
 #endif
-
-#if		(halHAS_DS18X20 == 1)
-			case OWFAMILY_10:							// DS1820 & DS18S20 Thermometer
-			case OWFAMILY_28:							// DS18B20 Thermometer
-				++Fam10_28Count ;
+		ow_search_t	sS ;
+		OWSearchInit(&sS, Chan, 0) ;
+		iRV = ds2482OWSearchNext(&sS) ;
+		while (iRV == 1) {
 #if		(ds18x20PWR_SOURCE == 1)
-				++PwrFlag ;								// Set flag to leave power on
+			PwrFlag += OWFamilyEnumerate(&sS) ;			// driver needs power left on
+#else
+			OWFamilyEnumerate(&sS) ;
 #endif
-				break ;
+#if		(halHAS_DS2409 == 1)
+			ds2409Learn(sS.ROM, Chan, ds2409TRUNK) ;
 #endif
-
-			default:
-				SL_ERR("Invalid/unsupported 1W family '0x%02X' found", sDS2482.ROM.Family) ;
-			}
 			++ChannelCount[Chan] ;
 			++iCount ;
-			IF_EXEC_1(debugTRACK, ds2482PrintROM, &sDS2482.ROM) ;
-			iRV = OWNext() ;
+			IF_EXEC_1(debugTRACK, ds2482PrintROM, sS.ROM) ;
+			iRV = ds2482OWSearchNext(&sS) ;
 		}
 #if		(ds18x20PWR_SOURCE == 1)
 		if (PwrFlag == 0) {
@@ -1039,7 +1484,16 @@ int32_t	ds2482CountDevices(void) {
 			xActuatorUnBlock(Chan) ;
 		}
 #endif
-		EQ_RETURN(iRV, erFAILURE) ;
+		if (iRV == erFAILURE) {
+			ds2482Unlock() ;
+			return erFAILURE ;
+		}
+#if		(halHAS_DS2409 == 1)
+		iRV = ds2409EnumerateBranches(Chan) ;			// devices behind couplers
+		ChannelCount[Chan] += iRV ;
+		iCount += iRV ;
+#endif
+		ds2482Unlock() ;
 	}
 	IF_PRINT(debugTRACK, "DS2482: Found %d device(s)\n", iCount) ;
 	return iCount ;
@@ -1063,7 +1517,11 @@ int32_t	ds2482Identify(uint8_t chanI2C, uint8_t addrI2C) {
 		sDS2482.sI2Cdev.dlayI2C			= 0 ;
 		return erFAILURE ;
 	}
-	sDS2482.Mux	= xSemaphoreCreateMutex() ;
+	sDS2482.Mux	= xSemaphoreCreateRecursiveMutex() ;
+	OWBusSelect(&ds2482Bus) ;
+	OWFamilyInit() ;
+	OWPolicyInit() ;
+	OWEventInit() ;
 	return erSUCCESS ;
 }
 
@@ -1072,20 +1530,19 @@ int32_t	ds2482Config(void) {
 	IF_SYSTIMER_INIT(debugTIMING, systimerDS2482B, systimerTICKS, "DS2482B", myMS_TO_TICKS(1), myMS_TO_TICKS(20)) ;
 	IF_SYSTIMER_INIT(debugTIMING, systimerDS2482WW, systimerTICKS, "DS2482WW", myMS_TO_TICKS(1), myMS_TO_TICKS(10)) ;
 
+	ds2482ArbAcquire(ds2482PRIO_ENUM) ;				// no sweep or scan while the tables are rebuilt
+	OWFamilyTeardown() ;								// undo a previous configuration, if any
+	memset(ChannelCount, 0, sizeof(ChannelCount)) ;
 	int32_t iRV = ds2482CountDevices() ;
-	LT_RETURN(iRV, 1) ;
-
-#if		(halHAS_DS1990X == 1)
-	ds1990xDiscover() ;
-#endif
-
-#if		(halHAS_DS18X20 == 1)
-	ds18x20Discover(URI_DS18X20) ;
-#endif
-	return erSUCCESS ;
+	if (iRV >= 1) {
+		iRV = OWFamilyDiscover() ;
+	}
+	ds2482ArbRelease() ;
+	return iRV ;
 }
 
 int32_t	ds2482TestsHandler(int32_t iCount, void * pVoid) {
+	(void) pVoid ;
 	return PRINT("#%d Ch%d %02X/%#M/%02X  ", iCount, sDS2482.CurChan, sDS2482.ROM.Family, sDS2482.ROM.TagNum, sDS2482.ROM.CRC) ;
 }
 
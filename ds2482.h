@@ -26,13 +26,14 @@
 
 #include	"hal_i2c.h"
 #include	"onewire.h"
+#include	"owbus.h"
 
 #include	<stdint.h>
 
 // ############################################# Macros ############################################
 
 #define	ds2482ADDR_0						0x18		// Device base address
-#define	ds2482RETRIES						1
+#define	ds2482RETRIES						3			// default owOP_SCRATCHPAD attempts
 #define	ds2482SINGLE_DEVICE					0
 
 #define	owDELAY_WB							1			// 0=Yield >0=mS Delay
@@ -41,9 +42,30 @@
 #define	owDELAY_RST							2			// Bus Reset
 #define	owDELAY_TB							1			// Touch Bit
 
+// DS2484 1-Wire port timing profiles, code 0x6 is the power-on default of every parameter
+#define	ds2484PROF_DEFAULT					0			// datasheet defaults, long/heavily loaded bus
+#define	ds2484PROF_SHORT					1			// short, lightly loaded bus (probes < ~10m)
+#define	ds2484PROF_NUM						2
+#define	ds2484PROFILE						ds2484PROF_DEFAULT	// applied by ds2482Detect()
+
+/* Busy time model, specialised per bridge at compile time: the -10x/-800 timing is fixed, the
+ * DS2484 follows the port profile (tW0L + tREC0 per slot). Used to size the busy poll loops */
+#if		(halHAS_DS2484 == 1 && ds2484PROFILE == ds2484PROF_SHORT)
+	#define	ds2482tSLOT_US					63			// tW0L 60uS + tREC0 2.75uS
+#elif	(halHAS_DS2484 == 1)
+	#define	ds2482tSLOT_US					70			// tW0L 64uS + tREC0 5.25uS
+#else
+	#define	ds2482tSLOT_US					73			// tSLOT 69uS + tREC0
+#endif
+#define	ds2482tRESET_US						1148		// tRSTL + tRSTH, upper bound for all bridges/profiles
+#define	ds2482tPOLL_US						50			// 1 byte status read at 400KHz
+#define	ds2482POLL_SPIN						((8 * ds2482tSLOT_US / ds2482tPOLL_US) + 8)	// status reads before yielding (fused byte I/O)
+#define	ds2482POLL_BURST					4			// status bytes per read, each is a fresh STAT
+
 // DS2482 config bits
 #define CONFIG_APU							0x01		// Active Pull Up
 #define CONFIG_PPM							0x02		// Presence Pulse Mask
+#define CONFIG_PDN							0x02		// 1-Wire Power Down (DS2484)
 #define CONFIG_SPU							0x04		// Strong Pull Up
 #define CONFIG_1WS							0x08		// 1-Wire Speed (0=Standard, 1= Overdrive)
 
@@ -61,8 +83,19 @@
 	#define	ds2482NUM_CHAN					1
 #elif	(halHAS_DS2482_800 == 1)
 	#define	ds2482NUM_CHAN					8
+#elif	(halHAS_DS2484 == 1)
+	#define	ds2482NUM_CHAN					1
 #endif
 
+// DS2484 Adjust 1-Wire Port parameters, byte is [P2 P1 P0 OD V3 V2 V1 V0]
+#define	ds2484P_tRSTL						0			// reset low time
+#define	ds2484P_tMSP						1			// presence detect sample time
+#define	ds2484P_tW0L						2			// write zero low time
+#define	ds2484P_tREC0						3			// write zero recovery time (no OD)
+#define	ds2484P_RWPU						4			// passive pull-up resistance (no OD)
+#define	ds2484PARAM(P, OD, Val)				(((P) << 5) | ((OD) << 4) | ((Val) & 0x0F))
+#define	ds2484PORT_NUM						8			// port configuration register bytes
+
 // ######################################## Enumerations ###########################################
 
 enum {													// Supported 1W families & devices
@@ -77,6 +110,7 @@ enum {
 	ds2482REG_CHAN,			// ONLY for the -800 but required for formula to work
 	ds2482REG_CONF,			// valid for -10x and -800
 	ds2482REG_NUM,
+	ds2484REG_PCFG = ds2482REG_NUM,	// DS2484 only, port config, not in ds2482_regs_t
 } ;
 
 // ######################################### Structures ############################################
@@ -127,33 +161,56 @@ typedef struct __attribute__((packed)) {				// DS2482 I2C <> 1Wire bridge
 	int32_t 		LastFamilyDiscrepancy ;
 	uint8_t 		crc8 ;
 	uint8_t			CurChan			: 3 ;
-	uint8_t			RegPntr			: 2 ;
+	uint8_t			RegPntr			: 3 ;
 	uint8_t 		LastDeviceFlag	: 1 ;
+	// shadow of the bridge state, used to elide redundant SRP, WCFG & CHSL transactions
+	uint8_t			ConfLast		: 4 ;			// config nibble last written/read back
+	uint8_t			ConfValid		: 1 ;			// ConfLast matches the device
+	uint8_t			ChanValid		: 1 ;			// CurChan matches the device
+	uint8_t			PntrValid		: 1 ;			// RegPntr matches the device
+	uint8_t			Spare			: 1 ;
 } ds2482_t ;
 
-DUMB_STATIC_ASSERT(sizeof(ds2482_t) == 36) ;
+DUMB_STATIC_ASSERT(sizeof(ds2482_t) == 37) ;
+
 
 // #################################### Public Data structures #####################################
 
 extern ds2482_t	sDS2482 ;
+extern const ow_bus_t ds2482Bus ;
 extern const	uint8_t	OWremapTable[] ;
 
 // ###################################### Private functions ########################################
 
-int32_t OWReset(void) ;
+int32_t ds2482OWReset(void) ;
 
 uint8_t	OWCheckCRC(uint8_t * buf, uint8_t buflen) ;
+uint16_t OWCalcCRC16(uint16_t crc16, const uint8_t * pBuf, size_t Len) ;
 void	OWAddress(uint8_t nAddrMethod) ;
-int32_t	OWWriteByte(uint8_t sendbyte) ;
 int32_t OWWriteBytePower(int32_t sendbyte) ;
 int32_t	OWWriteByteWait(uint8_t sendbyte) ;
-void	OWBlock(uint8_t * tran_buf, int32_t tran_len) ;
 int32_t	OWReadROM(void) ;
+int32_t OWSearch(void) ;
+int32_t ds2482OWSearchNext(ow_search_t * psS) ;
+int32_t OWFirst(void) ;
+int32_t OWNext(void) ;
 int32_t OWLevel(int32_t new_level) ;
+int32_t OWSpeed(int32_t new_speed) ;
 
-void	ds2482PrintROM(ow_rom_t * psOW_ROM) ;
+void	ds2482PrintROM(ow_rom_t sROM) ;
 uint8_t	ds2482Report(void) ;
 int32_t ds2482ChannelSelect(uint8_t Chan) ;
+void	ds2482ShadowInvalidate(void) ;
+int32_t	ds2482Lock(uint8_t Chan) ;
+void	ds2482Unlock(void) ;
+int32_t ds2482WriteConfig(void) ;
+int32_t	ds2482Recover(void) ;
+#if		(halHAS_DS2484 == 1)
+int32_t	ds2484PortConfig(const uint8_t * pParam, size_t Count) ;
+int32_t	ds2484PortProfile(uint8_t Profile) ;
+#endif
+int32_t	ds2482XactWriteByte(uint8_t Byte) ;
+int32_t	ds2482XactReadByte(void) ;
 
 int32_t	ds2482ScanChannelAll(void) ;
 
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482arb.c - bridge arbitration between priority classes
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"ds2482arb.h"
+#include	"ds2482.h"
+#include	"ds2482stats.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdatomic.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* The bridge is owned by one class at a time through sDS2482.Mux. Before taking the mutex a
+ * task registers as pending for its class. Having obtained the mutex it backs off again if a
+ * higher class is pending, so the mutex always ends up with the highest class waiting.
+ * Preemption only happens at transaction boundaries: long operations call ds2482ArbYield()
+ * between channels (scans) or devices (sweeps), which hands over if a higher class is pending.
+ * The iButton latency is thus bounded by the longest unit between yields: one channel search
+ * for an enumeration, one sensor transaction for an externally powered sweep, or the full
+ * conversion time for a parasitic sweep since the strong pullup can not be interrupted.
+ * The owner can acquire again (a reconfiguration scanning channels), nested acquires keep the
+ * outer class and do not yield, the outer session must complete as one unit. */
+
+// ######################################### Local data ############################################
+
+static	atomic_uint	Pending[ds2482PRIO_NUM] ;
+static	uint8_t		Owner = ds2482PRIO_NUM ;			// class holding the bridge
+static	uint8_t		Depth = 0 ;							// acquires by the owner, nested if > 1
+static	uint32_t	Yields[ds2482PRIO_NUM] ;			// times this class handed over
+static	uint32_t	MaxWait[ds2482PRIO_NUM] ;			// uSec, worst acquire latency
+
+// ####################################### Local functions #########################################
+
+static int32_t	ds2482ArbHigherPending(uint8_t Class) {
+	for (uint8_t Prio = 0; Prio < Class; ++Prio) {
+		if (atomic_load(&Pending[Prio])) {
+			return 1 ;
+		}
+	}
+	return 0 ;
+}
+
+// ####################################### Public functions ########################################
+
+/**
+ * ds2482ArbAcquire() - obtain the bridge for a priority class
+ * @param	Class	ds2482PRIO_????
+ */
+void	ds2482ArbAcquire(uint8_t Class) {
+	IF_myASSERT(debugPARAM, Class < ds2482PRIO_NUM) ;
+	if (Depth && xSemaphoreGetMutexHolder(sDS2482.Mux) == xTaskGetCurrentTaskHandle()) {
+		xSemaphoreTakeRecursive(sDS2482.Mux, portMAX_DELAY) ;	// nested, already the owner
+		++Depth ;
+		return ;
+	}
+	int64_t	Start = ds2482StatsNow() ;
+	atomic_fetch_add(&Pending[Class], 1) ;
+	for (;;) {
+		xSemaphoreTakeRecursive(sDS2482.Mux, portMAX_DELAY) ;
+		if (ds2482ArbHigherPending(Class) == 0) {
+			break ;
+		}
+		xSemaphoreGiveRecursive(sDS2482.Mux) ;		// let the higher class in first
+		vTaskDelay(1) ;
+	}
+	atomic_fetch_sub(&Pending[Class], 1) ;
+	Owner = Class ;
+	Depth = 1 ;
+	uint32_t	Wait = ds2482StatsNow() - Start ;
+	if (MaxWait[Class] < Wait) {
+		MaxWait[Class] = Wait ;
+	}
+}
+
+void	ds2482ArbRelease(void) {
+	IF_myASSERT(debugPARAM, Owner < ds2482PRIO_NUM && Depth > 0) ;
+	if (--Depth == 0) {
+		Owner = ds2482PRIO_NUM ;
+	}
+	xSemaphoreGiveRecursive(sDS2482.Mux) ;
+}
+
+/**
+ * ds2482ArbYield() - hand the bridge over if a higher class is waiting
+ * @brief	Only call between complete transactions. On return the selected channel, the
+ * 			ROM & search state may have been changed by the other class.
+ * @return	1 if the bridge was handed over (and reacquired), 0 if not or nested
+ */
+int32_t	ds2482ArbYield(void) {
+	uint8_t	Class = Owner ;
+	IF_myASSERT(debugPARAM, Class < ds2482PRIO_NUM) ;
+	if (Depth > 1 || ds2482ArbHigherPending(Class) == 0) {
+		return 0 ;
+	}
+	++Yields[Class] ;
+	ds2482ArbRelease() ;
+	ds2482ArbAcquire(Class) ;
+	return 1 ;
+}
+
+void	ds2482ArbReport(void) {
+	static const char * const ClassName[ds2482PRIO_NUM] = { "iButton", "Sensor", "Enum" } ;
+	for (uint8_t Class = 0; Class < ds2482PRIO_NUM; ++Class) {
+		PRINT("%-8s  Yields=%u  MaxWait=%uuS\n", ClassName[Class], Yields[Class], MaxWait[Class]) ;
+	}
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482arb.h - bridge arbitration between priority classes
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+
+// ######################################## Enumerations ###########################################
+
+enum {													// Priority classes, highest first
+	ds2482PRIO_IBUTTON,									// interactive, user waiting at a reader
+	ds2482PRIO_SENSOR,									// periodic sensor sweeps
+	ds2482PRIO_ENUM,									// background enumeration, diagnostics & benchmarks
+	ds2482PRIO_NUM,
+} ;
+
+// ###################################### Private functions ########################################
+
+void	ds2482ArbAcquire(uint8_t Class) ;
+void	ds2482ArbRelease(void) ;
+int32_t	ds2482ArbYield(void) ;
+void	ds2482ArbReport(void) ;
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482bench.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"ds2482bench.h"
+#include	"ds2482.h"
+#include	"ds2482stats.h"
+#include	"ds2482arb.h"
+
+#if		(halHAS_DS18X20 == 1)
+	#include	"ds18x20.h"
+#endif
+
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#if		(ESP32_PLATFORM == 0)
+	#include	<time.h>
+#endif
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* On target benchmarks of enumeration, addressing and sweep throughput, on a host
+ * tools/ds2482sim.c runs them against a simulated bridge over a range of device counts.
+ * Each result is a single JSON object per line, so a capture can be diffed between releases:
+ *	usec		elapsed (wall) time for all iterations
+ *	cpu_usec	processor time used, on target the benchmark task holds the CPU so equals usec
+ *	bus_usec	1-Wire bus time modelled from the reset/byte/triplet counts (standard speed),
+ *				bus activity only, conversion waits excluded
+ *	end_usec	end to end time including the waits (conversions, polls). On target the elapsed
+ *				time, on a host bus_usec plus the virtual time slept in vTaskDelay(), an upper
+ *				bound as polling sleeps overlap bus activity
+ *	i2c_trans	I2C transactions, i2c_bytes total bytes transferred
+ * Counts come from the always-on statistics so ds2482STATS must be enabled. */
+
+#define	owBUS_US_RESET						1244		// 1WRS incl presence detect
+#define	owBUS_US_BYTE						584			// 8 x 73uS time slots
+#define	owBUS_US_TRIPLET					219			// 3 x 73uS time slots
+
+static	ds2482_stats_t	sBench0, sBench1 ;
+static	int64_t			BenchStart, BenchCPU, BenchSlept ;
+static	int32_t			BenchCount ;
+
+// ################################# Benchmark support functions ###################################
+
+static int64_t	ds2482BenchCPU(void) {
+#if		(ESP32_PLATFORM == 1)
+	return ds2482StatsNow() ;
+#else
+	struct timespec sTS ;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &sTS) ;
+	return (int64_t) sTS.tv_sec * 1000000LL + sTS.tv_nsec / 1000 ;
+#endif
+}
+
+static int64_t	ds2482BenchSlept(void) {			// uSec not seen by the wall clock
+#if		(ESP32_PLATFORM == 1)
+	return 0 ;
+#else
+	return xHostVirtualMillis() * 1000LL ;
+#endif
+}
+
+static void ds2482BenchBegin(void) {
+	ds2482StatsSnapshot(&sBench0) ;
+	BenchStart	= ds2482StatsNow() ;
+	BenchCPU	= ds2482BenchCPU() ;
+	BenchSlept	= ds2482BenchSlept() ;
+}
+
+static void ds2482BenchEnd(const char * pName, int32_t Chan, int32_t Iter, int32_t Devices) {
+	int64_t	uSec = ds2482StatsNow() - BenchStart ;
+	int64_t	uCPU = ds2482BenchCPU() - BenchCPU ;
+	ds2482StatsSnapshot(&sBench1) ;
+	#define	DELTA(x)	(sBench1.x - sBench0.x)
+	uint32_t BusUs = DELTA(Hist[ds2482OP_RESET].Count) * owBUS_US_RESET +
+					(DELTA(Hist[ds2482OP_WRBYTE].Count) + DELTA(Hist[ds2482OP_RDBYTE].Count)) * owBUS_US_BYTE +
+					DELTA(Hist[ds2482OP_TRIPLET].Count) * owBUS_US_TRIPLET ;
+#if		(ESP32_PLATFORM == 1)
+	uint32_t EndUs = uSec ;								// bus & waits in real time
+#else
+	uint32_t EndUs = BusUs + (ds2482BenchSlept() - BenchSlept) ;
+#endif
+	ds2482BENCH_OUT("%s{\"bench\":\"%s\",\"chan\":%d,\"iter\":%d,\"devices\":%d,\"usec\":%u,\"cpu_usec\":%u,\"bus_usec\":%u,"
+			"\"end_usec\":%u,\"i2c_trans\":%u,\"i2c_bytes\":%u,\"busy_polls\":%u,\"crc_fail\":%u}\n",
+			BenchCount++ ? "," : "", pName, Chan, Iter, Devices, (uint32_t) uSec, (uint32_t) uCPU, BusUs, EndUs,
+			DELTA(Bridge.I2Ctrans), DELTA(Bridge.I2Cbytes), DELTA(Bridge.BusyPolls), DELTA(Bridge.CRCfail)) ;
+	#undef	DELTA
+}
+
+// ################################# Application support functions #################################
+
+/**
+ * ds2482Benchmark() - run all benchmarks, print results as a JSON array
+ * @param	Iter		iterations per benchmark, 0 for the default
+ */
+void	ds2482Benchmark(int32_t Iter) {
+	if (Iter <= 0) {
+		Iter = ds2482BENCH_ITER ;
+	}
+	int32_t	iRV, Count = 0 ;
+	BenchCount = 0 ;
+	ds2482BENCH_OUT("[\n") ;
+	ds2482ArbAcquire(ds2482PRIO_ENUM) ;
+	// Search enumeration time, per channel, versus the number of devices found
+	for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+#if		(halHAS_DS2482_800 == 1)
+		if (ds2482ChannelSelect(Chan) != erSUCCESS) {
+			continue ;
+		}
+#endif
+		ds2482BenchBegin() ;
+		for (int32_t i = 0; i < Iter; ++i) {
+			Count = 0 ;
+			iRV = OWFirst() ;
+			while (iRV == 1) {
+				++Count ;
+				iRV = OWNext() ;
+			}
+		}
+		ds2482BenchEnd("search", Chan, Iter, Count) ;
+	}
+	ds2482ArbRelease() ;
+
+	// Scan all channels, without and with a family filter
+	ds2482BenchBegin() ;
+	for (int32_t i = 0; i < Iter; ++i) {
+		Count = ds2482ScanAllChannels(0, NULL, NULL) ;
+	}
+	ds2482BenchEnd("scan_all", -1, Iter, Count) ;
+
+	ds2482BenchBegin() ;
+	for (int32_t i = 0; i < Iter; ++i) {
+		Count = ds2482ScanAllChannels(OWFAMILY_28, NULL, NULL) ;
+	}
+	ds2482BenchEnd("scan_fam28", -1, Iter, Count) ;
+
+#if		(halHAS_DS18X20 == 1)
+	if (Fam10_28Count) {
+		// Addressed scratchpad reads (Reset + MatchROM + ReadSP + 9 byte block)
+		ds2482ArbAcquire(ds2482PRIO_ENUM) ;
+		ds2482BenchBegin() ;
+		for (int32_t i = 0; i < Iter; ++i) {
+			for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+				ds18x20ReadScratchPad(&psDS18X20[Idx]) ;
+			}
+		}
+		ds2482BenchEnd("scratchpad", -1, Iter, Fam10_28Count) ;
+		ds2482ArbRelease() ;
+
+		// Complete convert & read cycle
+		ds2482BenchBegin() ;
+		for (int32_t i = 0; i < Iter; ++i) {
+			ds18x20ConvertAndReadAll(NULL) ;
+		}
+		ds2482BenchEnd("sweep", -1, Iter, Fam10_28Count) ;
+	}
+#endif
+	ds2482BENCH_OUT("]\n") ;
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482health.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"ds2482health.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Per channel health tracking. A channel is quarantined after ds2482HEALTH_MAX_FAIL successive
+ * failures, a high error rate or a short detected on ds2482HEALTH_MAX_SHORT successive 1-Wire
+ * resets. An iButton touching the reader shorts the bus for a single reset. A quarantined channel
+ * is skipped by scans and sweeps, except for a single probe once NextProbe has passed. A failed
+ * probe doubles the interval (up to PROBE_MS << MAX_BACKOFF), a successful one releases it. The
+ * backoff is only cleared after MIN_SAMPLES successes so a flapping channel is probed ever less.
+ * Presence pulse misses are NOT failures, an iButton channel is empty most of the time. */
+
+ds2482_health_t	sDS2482Health[ds2482NUM_CHAN] = { 0 } ;
+
+// ################################# Application support functions #################################
+
+static void ds2482HealthQuarantine(uint8_t Chan) {
+	ds2482_health_t * psH = &sDS2482Health[Chan] ;
+	if (psH->Quarantine == 0) {						// Backoff retained if released recently
+		SL_WARN("Ch%d quarantined Ok=%d Err=%d Short=%d", Chan, psH->OkCount, psH->ErrCount, psH->Short) ;
+		psH->Quarantine	= 1 ;
+	} else if (psH->Backoff < ds2482HEALTH_MAX_BACKOFF) {
+		++psH->Backoff ;
+	}
+	psH->Probing	= 0 ;
+	psH->NextProbe	= xTaskGetTickCount() + pdMS_TO_TICKS(ds2482HEALTH_PROBE_MS << psH->Backoff) ;
+}
+
+/**
+ * ds2482HealthUpdate() - record the outcome of an operation on a channel
+ * @param	Chan		channel the operation was performed on
+ * @param	Ok			non-zero if successful
+ */
+void	ds2482HealthUpdate(uint8_t Chan, int32_t Ok) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	ds2482_health_t * psH = &sDS2482Health[Chan] ;
+	if ((psH->OkCount + psH->ErrCount) >= ds2482HEALTH_WINDOW) {
+		psH->OkCount	>>= 1 ;							// decay, recent history counts most
+		psH->ErrCount	>>= 1 ;
+	}
+	if (Ok) {
+		++psH->OkCount ;
+		psH->ConsecFail	= 0 ;
+		psH->Short		= 0 ;
+		if (psH->Quarantine) {
+			SL_INFO("Ch%d released from quarantine", Chan) ;
+			psH->Quarantine	= 0 ;
+			psH->Probing	= 0 ;
+			psH->OkCount	= 1 ;						// start with a clean slate
+			psH->ErrCount	= 0 ;
+		} else if (psH->Backoff && psH->OkCount >= ds2482HEALTH_MIN_SAMPLES) {
+			psH->Backoff	= 0 ;						// stable again, forget the flapping history
+		}
+		return ;
+	}
+	++psH->ErrCount ;
+	if (psH->ConsecFail < UINT8_MAX) {
+		++psH->ConsecFail ;
+	}
+	if (psH->Quarantine ||								// failed probe
+		psH->ConsecFail >= ds2482HEALTH_MAX_FAIL ||
+		((psH->OkCount + psH->ErrCount) >= ds2482HEALTH_MIN_SAMPLES &&
+		 (psH->ErrCount * 100) > ((psH->OkCount + psH->ErrCount) * ds2482HEALTH_MAX_ERR_PCT))) {
+		ds2482HealthQuarantine(Chan) ;
+	}
+}
+
+/**
+ * ds2482HealthShort() - record the short (STATUS_SD) state of every 1-Wire reset
+ * @param	Short		non-zero if a short was detected, a clean reset restarts the count
+ */
+void	ds2482HealthShort(uint8_t Chan, int32_t Short) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	ds2482_health_t * psH = &sDS2482Health[Chan] ;
+	if (Short == 0) {
+		psH->Short = 0 ;
+		return ;
+	}
+	if (psH->Short < ds2482HEALTH_MAX_SHORT) {
+		++psH->Short ;
+	}
+	if (psH->Short == ds2482HEALTH_MAX_SHORT || psH->Quarantine) {	// not a button contact
+		++psH->ErrCount ;
+		ds2482HealthQuarantine(Chan) ;
+	}
+}
+
+/**
+ * ds2482HealthUsable() - check if a channel should be accessed
+ * @return	1 if healthy or a re-probe is due, 0 if quarantined
+ */
+int32_t	ds2482HealthUsable(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	ds2482_health_t * psH = &sDS2482Health[Chan] ;
+	if (psH->Quarantine == 0 || psH->Probing) {
+		return 1 ;
+	}
+	if ((int32_t) (xTaskGetTickCount() - psH->NextProbe) >= 0) {
+		psH->Probing = 1 ;
+		IF_PRINT(debugTRACK, "Ch%d probing, backoff=%d\n", Chan, psH->Backoff) ;
+		return 1 ;
+	}
+	return 0 ;
+}
+
+void	ds2482HealthReset(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Chan < ds2482NUM_CHAN) ;
+	memset(&sDS2482Health[Chan], 0, sizeof(ds2482_health_t)) ;
+}
+
+void	ds2482HealthReport(void) {
+	for (int32_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		ds2482_health_t * psH = &sDS2482Health[Chan] ;
+		PRINT("Ch%d  Ok=%d  Err=%d  Consec=%d  Short=%d  Quar=%d  Backoff=%d\n", Chan,
+				psH->OkCount, psH->ErrCount, psH->ConsecFail, psH->Short, psH->Quarantine, psH->Backoff) ;
+	}
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482health.h
+ */
+
+#pragma		once
+
+#include	"ds2482.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2482HEALTH_MAX_FAIL				3			// consecutive failures before quarantine
+#define	ds2482HEALTH_MIN_SAMPLES			16			// before error rate is considered
+#define	ds2482HEALTH_MAX_ERR_PCT			50			// error rate (%) before quarantine
+#define	ds2482HEALTH_WINDOW					256			// halve Ok/Err counts when sum exceeds
+#define	ds2482HEALTH_PROBE_MS				1000		// first re-probe interval
+#define	ds2482HEALTH_MAX_BACKOFF			6			// max probe interval = PROBE_MS << 6 = 64 sec
+#define	ds2482HEALTH_MAX_SHORT				2			// successive resets with a short, max 3
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {
+	TickType_t	NextProbe ;								// earliest time to re-probe if quarantined
+	uint16_t	OkCount ;								// decaying success/failure counts
+	uint16_t	ErrCount ;
+	uint8_t		ConsecFail ;
+	uint8_t		Backoff		: 4 ;						// exponent for re-probe interval
+	uint8_t		Short		: 2 ;						// successive resets with a short detected
+	uint8_t		Quarantine	: 1 ;
+	uint8_t		Probing		: 1 ;						// quarantined, but current access is a probe
+} ds2482_health_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ds2482_health_t) == 10) ;
+
+// #################################### Public Data structures #####################################
+
+extern ds2482_health_t	sDS2482Health[ds2482NUM_CHAN] ;
+
+// ###################################### Private functions ########################################
+
+void	ds2482HealthUpdate(uint8_t Chan, int32_t Ok) ;
+void	ds2482HealthShort(uint8_t Chan, int32_t Short) ;
+int32_t	ds2482HealthUsable(uint8_t Chan) ;
+void	ds2482HealthReset(uint8_t Chan) ;
+void	ds2482HealthReport(void) ;
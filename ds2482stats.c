@@ -0,0 +1,124 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482stats.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"ds2482stats.h"
+
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#if		(ESP32_PLATFORM == 1)
+	#include	"esp_timer.h"
+#else
+	#include	<time.h>
+#endif
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Always-on instrumentation, each update is an increment or a count-leading-zeros plus a few
+ * adds so it can remain enabled in production. Counters are only updated by the task owning
+ * the bus, a snapshot taken from another task could be (harmlessly) a few counts stale. */
+
+ds2482_stats_t	sDS2482Stats = { 0 } ;
+
+const char * const ds2482OpNames[ds2482OP_NUM] = { "Reset", "WrByte", "RdByte", "Triplet", "Search", "Sweep" } ;
+
+// ################################# Application support functions #################################
+
+int64_t	ds2482StatsNow(void) {
+#if		(ESP32_PLATFORM == 1)
+	return esp_timer_get_time() ;
+#else
+	struct timespec sTS ;
+	clock_gettime(CLOCK_MONOTONIC, &sTS) ;
+	return ((int64_t) sTS.tv_sec * 1000000LL) + (sTS.tv_nsec / 1000) ;
+#endif
+}
+
+void	ds2482StatsHist(uint8_t Op, int64_t uSec) {
+	IF_myASSERT(debugPARAM, Op < ds2482OP_NUM) ;
+	ds2482_hist_t * psHist = &sDS2482Stats.Hist[Op] ;
+	uint32_t Val = (uSec < 0) ? 0 : (uSec > UINT32_MAX) ? UINT32_MAX : (uint32_t) uSec ;
+	uint32_t Idx = (Val == 0) ? 0 : 32 - __builtin_clz(Val) ;
+	if (Idx >= ds2482STAT_BUCKETS) {
+		Idx = ds2482STAT_BUCKETS - 1 ;
+	}
+	++psHist->Bucket[Idx] ;
+	if (psHist->Count == 0 || Val < psHist->Min) {
+		psHist->Min = Val ;
+	}
+	if (Val > psHist->Max) {
+		psHist->Max = Val ;
+	}
+	psHist->Sum += Val ;
+	++psHist->Count ;
+}
+
+void	ds2482StatsSnapshot(ds2482_stats_t * psStats) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psStats)) ;
+	memcpy(psStats, &sDS2482Stats, sizeof(ds2482_stats_t)) ;
+}
+
+void	ds2482StatsReset(void) { memset(&sDS2482Stats, 0, sizeof(ds2482_stats_t)) ; }
+
+static void ds2482StatsReportCount(const char * pName, ds2482_count_t * psCount) {
+	PRINT("%s  I2C=%u/%uB/%uE  Busy=%u  CRC=%u  NoPD=%u  Elided=%u  Recover=%u\n", pName,
+			psCount->I2Ctrans, psCount->I2Cbytes, psCount->I2Cerrors, psCount->BusyPolls,
+			psCount->CRCfail, psCount->NoPresence, psCount->Elided, psCount->Recoveries) ;
+}
+
+void	ds2482StatsReport(void) {
+	ds2482_stats_t	sStats ;
+	ds2482StatsSnapshot(&sStats) ;
+	ds2482StatsReportCount("Bridge", &sStats.Bridge) ;
+	for (int32_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		PRINT("Ch%d ", Chan) ;
+		ds2482StatsReportCount("", &sStats.Chan[Chan]) ;
+	}
+	for (int32_t Op = 0; Op < ds2482OP_NUM; ++Op) {
+		ds2482_hist_t * psHist = &sStats.Hist[Op] ;
+		if (psHist->Count == 0) {
+			continue ;
+		}
+		PRINT("%-8s #=%u  Min=%u  Avg=%u  Max=%u uS  [", ds2482OpNames[Op], psHist->Count,
+				psHist->Min, (uint32_t) (psHist->Sum / psHist->Count), psHist->Max) ;
+		for (int32_t Idx = 0; Idx < ds2482STAT_BUCKETS; ++Idx) {
+			PRINT(" %u", psHist->Bucket[Idx]) ;
+		}
+		PRINT(" ]\n") ;
+	}
+}
+
+#endif
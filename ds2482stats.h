@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482stats.h
+ */
+
+#pragma		once
+
+#include	"ds2482.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2482STATS							1			// 0=disable 1=enable counters & histograms
+#define	ds2482STAT_BUCKETS					24			// log2(uSec) buckets, last is >= 2^22 uSec (4.2 Sec)
+
+#if		(ds2482STATS == 1)
+	#define	ds2482STAT_INC(Member)			do { ++sDS2482Stats.Bridge.Member ; ++sDS2482Stats.Chan[sDS2482.CurChan].Member ; } while(0)
+	#define	ds2482STAT_ADD(Member, Val)		do { sDS2482Stats.Bridge.Member += (Val) ; sDS2482Stats.Chan[sDS2482.CurChan].Member += (Val) ; } while(0)
+	#define	ds2482STAT_START(Var)			int64_t Var = ds2482StatsNow()
+	#define	ds2482STAT_STOP(Op, Var)		ds2482StatsHist(Op, ds2482StatsNow() - Var)
+#else
+	#define	ds2482STAT_INC(Member)
+	#define	ds2482STAT_ADD(Member, Val)
+	#define	ds2482STAT_START(Var)
+	#define	ds2482STAT_STOP(Op, Var)
+#endif
+
+// ######################################## Enumerations ###########################################
+
+enum {													// Operations with latency histograms
+	ds2482OP_RESET,
+	ds2482OP_WRBYTE,
+	ds2482OP_RDBYTE,
+	ds2482OP_TRIPLET,
+	ds2482OP_SEARCH,
+	ds2482OP_SWEEP,										// full DS18x20 convert & read cycle
+	ds2482OP_NUM,
+} ;
+
+// ######################################### Structures ############################################
+
+typedef struct {
+	uint32_t	I2Ctrans ;								// I2C transactions (W, R or W+Sr+R)
+	uint32_t	I2Cbytes ;								// bytes written + read
+	uint32_t	I2Cerrors ;								// I2C transactions failed
+	uint32_t	BusyPolls ;								// status reads in ds2482WaitNotBusy()
+	uint32_t	CRCfail ;
+	uint32_t	NoPresence ;							// 1-Wire reset without presence pulse
+	uint32_t	Elided ;								// SRP/WCFG/CHSL skipped, shadow state matched
+	uint32_t	Recoveries ;							// bridge resets with state replayed
+} ds2482_count_t ;
+
+typedef struct {
+	uint32_t	Count ;
+	uint32_t	Min, Max ;								// uSec
+	uint64_t	Sum ;									// uSec
+	uint32_t	Bucket[ds2482STAT_BUCKETS] ;			// [n] = 2^(n-1) <= uSec < 2^n
+} ds2482_hist_t ;
+
+typedef struct {
+	ds2482_count_t	Bridge ;
+	ds2482_count_t	Chan[ds2482NUM_CHAN] ;
+	ds2482_hist_t	Hist[ds2482OP_NUM] ;
+} ds2482_stats_t ;
+
+// #################################### Public Data structures #####################################
+
+extern ds2482_stats_t	sDS2482Stats ;
+
+// ###################################### Private functions ########################################
+
+int64_t	ds2482StatsNow(void) ;
+void	ds2482StatsHist(uint8_t Op, int64_t uSec) ;
+void	ds2482StatsSnapshot(ds2482_stats_t * psStats) ;
+void	ds2482StatsReset(void) ;
+void	ds2482StatsReport(void) ;
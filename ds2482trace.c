@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482trace.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"ds2482trace.h"
+#include	"ds2482stats.h"
+
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Fixed size ring of the most recent I2C transactions to/from the bridge, recorded by the I2C
+ * wrappers in ds2482.c while the bus is owned, so no locking. Costs 12 bytes and a timestamp
+ * per transaction. ds2482TraceDump() returns a binary image (header + records, oldest first)
+ * and ds2482TraceReport() prints the same image as "D2TR:" hex lines to be captured from the
+ * console and analysed/replayed on a host with tools/ds2482trace.c */
+
+DUMB_STATIC_ASSERT(sizeof(ds2482_trace_t) == 12) ;
+DUMB_STATIC_ASSERT(sizeof(ds2482_trace_hdr_t) == 8) ;
+DUMB_STATIC_ASSERT((ds2482TRACE_SIZE & (ds2482TRACE_SIZE - 1)) == 0) ;
+
+static	ds2482_trace_t	sTrace[ds2482TRACE_SIZE] ;
+static	uint32_t		TraceIdx = 0 ;					// total records written, wraps
+static	uint8_t			TraceOn = 1 ;
+
+// ################################# Application support functions #################################
+
+void	ds2482TraceRecord(uint8_t Op, uint8_t Addr, const uint8_t * pTx, size_t TxLen, const uint8_t * pRx, size_t RxLen, int32_t Result) {
+	if (TraceOn == 0) {
+		return ;
+	}
+	ds2482_trace_t * psTR = &sTrace[TraceIdx++ & (ds2482TRACE_SIZE - 1)] ;
+	psTR->usecs		= (uint32_t) ds2482StatsNow() ;
+	psTR->Op		= Op ;
+	psTR->Addr		= Addr ;
+	psTR->TxLen		= (TxLen > 15) ? 15 : TxLen ;
+	psTR->RxLen		= (RxLen > 15) ? 15 : RxLen ;
+	psTR->Result	= Result ;
+	psTR->Tx[0]		= (TxLen > 0) ? pTx[0] : 0 ;
+	psTR->Tx[1]		= (TxLen > 1) ? pTx[1] : 0 ;
+	psTR->Rx[0]		= (RxLen > 0 && Result == erSUCCESS) ? pRx[0] : 0 ;
+	psTR->Rx[1]		= (RxLen > 1 && Result == erSUCCESS) ? pRx[1] : 0 ;
+}
+
+void	ds2482TraceEnable(int32_t Enable) { TraceOn = Enable ? 1 : 0 ; }
+
+void	ds2482TraceClear(void) { TraceIdx = 0 ; }
+
+/**
+ * ds2482TraceDump() - copy the trace as header + records, oldest record first
+ * @param	pBuf		buffer to copy into
+ * @param	Size		size of buffer, records that do not fit are skipped (oldest first)
+ * @return	number of bytes copied
+ */
+size_t	ds2482TraceDump(uint8_t * pBuf, size_t Size) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(pBuf)) ;
+	if (Size < sizeof(ds2482_trace_hdr_t)) {
+		return 0 ;
+	}
+	uint32_t Count = (TraceIdx < ds2482TRACE_SIZE) ? TraceIdx : ds2482TRACE_SIZE ;
+	uint32_t Fit = (Size - sizeof(ds2482_trace_hdr_t)) / sizeof(ds2482_trace_t) ;
+	if (Count > Fit) {
+		Count = Fit ;
+	}
+	ds2482_trace_hdr_t sHdr = { .Magic = ds2482TRACE_MAGIC, .Version = ds2482TRACE_VERSION, .Count = Count } ;
+	memcpy(pBuf, &sHdr, sizeof(sHdr)) ;
+	pBuf += sizeof(sHdr) ;
+	for (uint32_t Idx = TraceIdx - Count; Idx != TraceIdx; ++Idx) {
+		memcpy(pBuf, &sTrace[Idx & (ds2482TRACE_SIZE - 1)], sizeof(ds2482_trace_t)) ;
+		pBuf += sizeof(ds2482_trace_t) ;
+	}
+	return sizeof(ds2482_trace_hdr_t) + (Count * sizeof(ds2482_trace_t)) ;
+}
+
+void	ds2482TraceReport(void) {
+	uint8_t	Save = TraceOn ;
+	TraceOn = 0 ;										// freeze while printing
+	uint32_t Count = (TraceIdx < ds2482TRACE_SIZE) ? TraceIdx : ds2482TRACE_SIZE ;
+	ds2482_trace_hdr_t sHdr = { .Magic = ds2482TRACE_MAGIC, .Version = ds2482TRACE_VERSION, .Count = Count } ;
+	uint8_t * pU8 = (uint8_t *) &sHdr ;
+	PRINT("D2TR:") ;
+	for (size_t i = 0; i < sizeof(sHdr); ++i) {
+		PRINT("%02X", pU8[i]) ;
+	}
+	PRINT("\n") ;
+	for (uint32_t Idx = TraceIdx - Count; Idx != TraceIdx; ++Idx) {
+		pU8 = (uint8_t *) &sTrace[Idx & (ds2482TRACE_SIZE - 1)] ;
+		PRINT("D2TR:") ;
+		for (size_t i = 0; i < sizeof(ds2482_trace_t); ++i) {
+			PRINT("%02X", pU8[i]) ;
+		}
+		PRINT("\n") ;
+	}
+	TraceOn = Save ;
+}
+
+#endif
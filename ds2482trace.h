@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482trace.h
+ *
+ * Record format is shared with tools/ds2482trace.c so only depends on standard headers
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+#include	<stddef.h>
+
+// ############################################# Macros ############################################
+
+#define	ds2482TRACE							1			// 0=disable 1=record I2C transactions
+#define	ds2482TRACE_SIZE					256			// records, MUST be a power of 2
+#define	ds2482TRACE_MAGIC					0x52543244	// "D2TR"
+#define	ds2482TRACE_VERSION					1
+
+// ######################################## Enumerations ###########################################
+
+enum {													// I2C transaction types
+	ds2482TR_WRITE,
+	ds2482TR_READ,
+	ds2482TR_WRITEREAD,									// Write + Repeated start + Read
+} ;
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {
+	uint32_t	usecs ;									// low 32 bits of the uSec timestamp
+	uint8_t		Op ;									// ds2482TR_????
+	uint8_t		Addr ;									// I2C address
+	uint8_t		TxLen	: 4 ;							// bytes written
+	uint8_t		RxLen	: 4 ;							// bytes read
+	int8_t		Result ;								// erSUCCESS or error code
+	uint8_t		Tx[2] ;									// first 2 bytes written (command + parameter)
+	uint8_t		Rx[2] ;									// first 2 bytes read
+} ds2482_trace_t ;
+
+typedef struct __attribute__((packed)) {
+	uint32_t	Magic ;
+	uint16_t	Version ;
+	uint16_t	Count ;									// records following, oldest first
+} ds2482_trace_hdr_t ;
+
+// ###################################### Private functions ########################################
+
+void	ds2482TraceRecord(uint8_t Op, uint8_t Addr, const uint8_t * pTx, size_t TxLen, const uint8_t * pRx, size_t RxLen, int32_t Result) ;
+void	ds2482TraceEnable(int32_t Enable) ;
+void	ds2482TraceClear(void) ;
+size_t	ds2482TraceDump(uint8_t * pBuf, size_t Size) ;
+void	ds2482TraceReport(void) ;
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds28ea00.c - DS28EA00 sequence detect (Chain mode) enumeration
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_DS18X20 == 1)
+
+#include	"ds28ea00.h"
+#include	"ds2482.h"
+#include	"ds2482health.h"
+#include	"ds2482arb.h"
+#include	"owxact.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* With Chain ON every DS28EA00 whose EN input is low (first in the cable, or the one before it is
+ * DONE) answers a Conditional Read ROM. Marking it DONE drives its PIOB low, enabling the next in
+ * the cable. Repeating until the read returns all 1s lists the devices in physical order, in one
+ * pass, no search tree. Temperature conversion & reads are done by the DS18x20 sweep (ds18x20.c).
+ *	Reset, SkipROM, Chain ON
+ *	{ Reset, Conditional Read ROM, Chain DONE } until ROM == FF..FF
+ *	Reset, SkipROM, Chain OFF */
+
+// ####################################### Local functions #########################################
+
+/**
+ * ds28ea00Chain() - send a Chain control command & check the confirmation
+ * @param	Flags	owXACT_RESET | owXACT_SKIP for ON/OFF, 0 for DONE (device still selected)
+ * @return	1 if confirmed, 0 if not, erFAILURE
+ */
+static int32_t	ds28ea00Chain(uint8_t Flags, uint8_t Ctl) {
+	uint8_t	cTx[2] = { Ctl, ~Ctl }, cRx ;
+	ow_xact_t	sXact = {
+		.Flags = Flags, .Cmd = DS28EA00_CHAIN, .pTx = cTx, .TxLen = sizeof(cTx), .pRx = &cRx, .RxLen = sizeof(cRx),
+	} ;
+	int32_t	iRV = OWXactRun(&sXact) ;
+	if (iRV != 1) {
+		return iRV ;
+	}
+	return (cRx == DS28EA00_CHAIN_ACK) ? 1 : 0 ;
+}
+
+// ################################### Global/public functions #####################################
+
+/**
+ * ds28ea00Sequence() - list the DS28EA00s on a channel in cable order
+ * @param	psROM	array to receive the ROMs, [0] is the first in the cable
+ * @return	number of devices found or erFAILURE
+ */
+int32_t	ds28ea00Sequence(uint8_t Chan, ow_rom_t * psROM, int32_t Max) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psROM)) ;
+	if (ds2482Lock(Chan) != erSUCCESS) {				// held for the whole sequence
+		return erFAILURE ;
+	}
+	int32_t	Count = 0 ;
+	int32_t	iRV = ds28ea00Chain(owXACT_RESET | owXACT_SKIP, DS28EA00_CHAIN_ON) ;
+	if (iRV == 1) {
+		ow_xact_t	sXact = { .Flags = owXACT_RESET, .Cmd = DS28EA00_COND_READROM, .RxLen = sizeof(ow_rom_t) } ;
+		while (Count < Max) {
+			sXact.pRx = psROM[Count].HexChars ;
+			iRV = OWXactRun(&sXact) ;
+			if (iRV != 1 || psROM[Count].Value == UINT64_MAX) {
+				break ;									// no presence or end of the chain
+			}
+			if (OWCheckCRC(psROM[Count].HexChars, sizeof(ow_rom_t)) == 0 || psROM[Count].Family != OWFAMILY_42) {
+				SL_ERR("Ch%d chain broken at #%d", Chan, Count) ;
+				iRV = erFAILURE ;
+				break ;
+			}
+			iRV = ds28ea00Chain(0, DS28EA00_CHAIN_DONE) ;
+			if (iRV != 1) {								// would read the same device again
+				SL_ERR("Ch%d DONE not confirmed at #%d", Chan, Count) ;
+				iRV = erFAILURE ;
+				break ;
+			}
+			++Count ;
+		}
+		ds28ea00Chain(owXACT_RESET | owXACT_SKIP, DS28EA00_CHAIN_OFF) ;	// release EN/PIOB
+	}
+	ds2482Unlock() ;
+	IF_PRINT(debugTRACK, "Ch%d DS28EA00 chain=%d\n", Chan, Count) ;
+	return (iRV == erFAILURE) ? erFAILURE : Count ;
+}
+
+/**
+ * ds28ea00ScanChain() - sequence every channel, call Handler per device in cable order
+ * @brief	Handler gets the running count and the ROM in sDS2482.ROM with the channel selected,
+ * 			as with ds2482ScanAllChannels(). Called after Chain OFF, free to use the bus.
+ * @return	number of devices handled or erFAILURE
+ */
+int32_t	ds28ea00ScanChain(int32_t (* Handler)(int32_t, void *), void * pVoid) {
+	ow_rom_t	sROM[ds28ea00CHAIN_MAX] ;
+	int32_t	iRV = erSUCCESS, xCount = 0 ;
+	ds2482ArbAcquire(ds2482PRIO_ENUM) ;
+	for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		if (Chan) {
+			ds2482ArbYield() ;
+		}
+		if (ds2482HealthUsable(Chan) == 0) {
+			continue ;
+		}
+		int32_t	Count = ds28ea00Sequence(Chan, sROM, ds28ea00CHAIN_MAX) ;
+		if (Count < 0) {
+			iRV = Count ;
+			continue ;									// other channels can still be done
+		}
+		for (int32_t Pos = 0; Pos < Count && ds2482Lock(Chan) == erSUCCESS; ++Pos) {
+			memcpy(&sDS2482.ROM, &sROM[Pos], sizeof(ow_rom_t)) ;
+			Handler(xCount + Pos, pVoid) ;
+			ds2482Unlock() ;
+		}
+		xCount += Count ;
+	}
+	ds2482ArbRelease() ;
+	return (iRV < erSUCCESS && xCount == 0) ? iRV : xCount ;
+}
+
+#endif
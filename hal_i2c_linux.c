@@ -0,0 +1,120 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * hal_i2c_linux.c - halI2C_????() on Linux i2c-dev, for gateways running the driver in user space
+ *
+ * The driver itself still needs the FreeRTOS mutex, tick & delay calls, on Linux those come from
+ * tools/host (pthread mutexes, CLOCK_MONOTONIC ticks) along with the application headers.
+ * tools/ds2482scan.c is the reference program, its build line lists the modules to link.
+ */
+
+#include	"x_config.h"
+
+#if		(ESP32_PLATFORM == 0) && (halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"hal_i2c.h"
+
+#include	"printfx.h"
+#include	"syslog.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<linux/i2c.h>
+#include	<linux/i2c-dev.h>
+#include	<sys/ioctl.h>
+#include	<fcntl.h>
+#include	<unistd.h>
+#include	<stdio.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* chanI2C is the N in /dev/i2c-N, opened on first use. Every call is a single I2C_RDWR ioctl, a
+ * write + read becomes 2 messages in one combined transfer, so the kernel adapter issues the
+ * repeated start (SRP+read, WCFG & CHSL read back, 1-Wire command + first status) exactly as
+ * the ESP32 hal does, and a multi byte status poll is 1 message and 1 syscall.
+ * Needs an adapter supporting I2C_FUNC_I2C (SoC controllers, i2c-tiny-usb, ...). The kernel
+ * i2c-stub module only does SMBus transfers and is refused at open. Without hardware link
+ * tools/ds2482sim.c instead, its simulated DS2482-800 provides these 3 functions in user space. */
+
+#define	halI2C_LINUX_BUSES			16
+
+static int32_t	halI2C_fd[halI2C_LINUX_BUSES] = { 0 } ;		// fd + 1, 0 = not opened
+
+// ####################################### Local functions #########################################
+
+static int32_t	halI2C_Open(uint8_t chanI2C) {
+	IF_myASSERT(debugPARAM, chanI2C < halI2C_LINUX_BUSES) ;
+	if (halI2C_fd[chanI2C] == 0) {
+		char	caDev[16] ;
+		snprintf(caDev, sizeof(caDev), "/dev/i2c-%d", chanI2C) ;
+		int32_t	fd = open(caDev, O_RDWR) ;
+		unsigned long Funcs ;
+		if (fd < 0 || ioctl(fd, I2C_FUNCS, &Funcs) < 0 || (Funcs & I2C_FUNC_I2C) == 0) {
+			SL_ERR("%s open/combined transfers failed", caDev) ;
+			if (fd >= 0) {
+				close(fd) ;
+			}
+			return erFAILURE ;
+		}
+		halI2C_fd[chanI2C] = fd + 1 ;
+	}
+	return halI2C_fd[chanI2C] - 1 ;
+}
+
+static int32_t	halI2C_Transfer(halI2Cdev_t * psI2Cdev, struct i2c_msg * psMsg, int32_t Count) {
+	int32_t	fd = halI2C_Open(psI2Cdev->chanI2C) ;
+	if (fd < 0) {
+		return erFAILURE ;
+	}
+	struct i2c_rdwr_ioctl_data sXfer = { .msgs = psMsg, .nmsgs = Count } ;
+	if (ioctl(fd, I2C_RDWR, &sXfer) != Count) {
+		IF_PRINT(debugRESULT, "I2C 0x%02X xfer failed\n", psI2Cdev->addrI2C) ;
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+// ################################### Global/public functions #####################################
+
+int32_t	halI2C_Write(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize) {
+	struct i2c_msg sMsg = { .addr = psI2Cdev->addrI2C, .flags = 0, .len = TxSize, .buf = pTxBuf } ;
+	return halI2C_Transfer(psI2Cdev, &sMsg, 1) ;
+}
+
+int32_t	halI2C_Read(halI2Cdev_t * psI2Cdev, uint8_t * pRxBuf, size_t RxSize) {
+	struct i2c_msg sMsg = { .addr = psI2Cdev->addrI2C, .flags = I2C_M_RD, .len = RxSize, .buf = pRxBuf } ;
+	return halI2C_Transfer(psI2Cdev, &sMsg, 1) ;
+}
+
+int32_t	halI2C_WriteRead(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize, uint8_t * pRxBuf, size_t RxSize) {
+	struct i2c_msg sMsg[2] = {
+		{ .addr = psI2Cdev->addrI2C, .flags = 0,		.len = TxSize, .buf = pTxBuf },
+		{ .addr = psI2Cdev->addrI2C, .flags = I2C_M_RD,	.len = RxSize, .buf = pRxBuf },
+	} ;
+	return halI2C_Transfer(psI2Cdev, sMsg, 2) ;
+}
+
+#endif
@@ -39,6 +39,8 @@
 #define OW_CMD_MATCHROM      				0x55
 #define OW_CMD_SKIPROM       				0xCC
 #define OW_CMD_ALARMSEARCH   				0xEC
+#define OW_CMD_SKIPROM_OD					0x3C		// Overdrive Skip ROM
+#define OW_CMD_MATCHROM_OD					0x69		// Overdrive Match ROM, ROM sent at overdrive
 
 // ################################### DS2482 1-Wire Commands ######################################
 
@@ -46,6 +48,7 @@
 #define CMD_SRP								0xE1		// Set Read Pointer
 #define CMD_WCFG   							0xD2		// Write Config
 #define CMD_CHSL   							0xC3		// Channel Select (-800)
+#define CMD_APORT							0xC3		// Adjust 1-Wire Port (DS2484)
 #define CMD_1WRS   							0xB4		// 1-Wire Reset
 #define CMD_1WWB   							0xA5		// 1-Wire Write Byte
 #define CMD_1WRB   							0x96		// 1-Wire Read Byte
@@ -61,6 +64,55 @@
 #define	DS18X20_RECALL_EE					0xB8
 #define	DS18X20_READ_SP						0xBE
 
+// ################################## DS28EA00 1-Wire Commands #####################################
+
+#define	DS28EA00_CHAIN						0x99		// + control byte & its complement
+#define	DS28EA00_CHAIN_OFF					0x3C
+#define	DS28EA00_CHAIN_ON					0x5A
+#define	DS28EA00_CHAIN_DONE					0x96
+#define	DS28EA00_CHAIN_ACK					0xAA		// confirmation read after the command
+#define	DS28EA00_COND_READROM				0x0F		// only the device with EN low & not DONE
+
+// ############################### DS2408 & DS2413 1-Wire Commands #################################
+
+#define	DS2408_PIO_READ						0xF5		// Channel (PIO) Access Read, continuous
+#define	DS2408_PIO_WRITE					0x5A		// + byte & its complement, repeatable
+#define	DS2408_PIO_ACK						0xAA		// confirmation after a PIO write
+#define	DS2408_READ_REG						0xF0		// + TA1 TA2, registers up to 0x8F then CRC16
+#define	DS2408_REG_LATCH					0x0089		// PIO output latch state register
+#define	DS2408_REG_END						0x008F		// last register of the control space
+#define	DS2408_CRC_BLOCK					32			// DS2408 samples per CRC16
+
+// ############################ EEPROM & NV RAM Memory 1-Wire Commands #############################
+
+#define	OWMEM_WRITE_SP						0x0F		// + TA1 TA2 data [CRC16]
+#define	OWMEM_COPY_SP						0x55		// + TA1 TA2 E/S authorisation
+#define	OWMEM_READ_EXT						0xA5		// + TA1 TA2, CRC16 after every page
+#define	OWMEM_READ_SP						0xAA		// TA1 TA2 E/S data [CRC16]
+#define	OWMEM_READ							0xF0		// + TA1 TA2, continuous to end of memory
+#define	OWMEM_READ_PW						0x69		// + TA1 TA2 password[8] 0xFF, CRC16 after every page
+#define	OWMEM_COPY_ACK						0xAA		// read after a successful copy
+#define	OWMEM_ES_PF							0x20		// E/S partial byte flag
+
+// ################################### DS2450 1-Wire Commands ######################################
+
+#define	DS2450_CONVERT						0x3C		// + input mask, readout control [CRC16]
+#define	DS2450_WRITE_MEM					0x55		// + TA1 TA2 data [CRC16] [data read back]
+#define	DS2450_READ_MEM						0xAA		// + TA1 TA2, data to end of page [CRC16]
+#define	DS2450_PAGE_RESULT					0x00		// conversion results, 2 bytes per input
+#define	DS2450_PAGE_CONTROL					0x08		// control/status, 2 bytes per input
+#define	DS2450_VCC_CTRL						0x1C		// power mode
+#define	DS2450_VCC_ON						0x40
+
+// ################################### DS2409 1-Wire Commands ######################################
+
+#define	DS2409_SMART_AUX					0x33		// + reset stimulus, presence, confirmation
+#define	DS2409_STATUS						0x5A		// + control byte, status, confirmation
+#define	DS2409_ALL_OFF						0x66		// confirmation
+#define	DS2409_DISCHARGE					0x99		// confirmation
+#define	DS2409_DIRECT_MAIN					0xA5		// confirmation
+#define	DS2409_SMART_MAIN					0xCC		// + reset stimulus, presence, confirmation
+
 // ##################################### iButton Family Codes #####################################
 
 #define	OWFAMILY_01		0x01			// (DS1990A), (DS1990R), DS2401, DS2411	1-Wire net address (registration number) only
@@ -125,6 +177,18 @@ typedef union ow_rom_u {
 
 DUMB_STATIC_ASSERT( sizeof(ow_rom_t) == ONEWIRE_ROM_LENGTH) ;
 
+typedef struct __attribute__((packed)) {				// per caller search state
+	ow_rom_t		ROM ;
+	int32_t 		LastDiscrepancy ;
+	int32_t 		LastFamilyDiscrepancy ;
+	uint8_t 		crc8 ;
+	uint8_t			Chan			: 3 ;
+	uint8_t 		LastDeviceFlag	: 1 ;
+	uint8_t			Spare			: 4 ;
+} ow_search_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ow_search_t) == 18) ;
+
 // ###################################### Private functions ########################################
 
 
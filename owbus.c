@@ -0,0 +1,166 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owbus.c - 1-Wire transport abstraction
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1 || halHAS_DS2480B == 1)
+
+#include	"owbus.h"
+
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Device independent 1-Wire code goes through these. The active master is the one selected last,
+ * by ds2482Identify() or ds2480bIdentify(), so with both fitted the order of identification
+ * decides. Code tied to the DS2482 (owxact.c, owmem.c & the family drivers using the fused bridge
+ * primitives) does not depend on this selection, it always talks to the DS2482 directly. */
+
+const ow_bus_t * psOWBus = NULL ;
+
+// ################################# Application support functions #################################
+
+void	OWBusSelect(const ow_bus_t * psBus) {
+	IF_myASSERT(debugPARAM, psBus != NULL) ;
+	IF_PRINT(debugTRACK && psOWBus && psOWBus != psBus, "1-Wire bus %s replaced\n", psOWBus->pName) ;
+	psOWBus = psBus ;
+	IF_PRINT(debugTRACK, "1-Wire bus=%s\n", psBus->pName) ;
+}
+
+int32_t	OWBusLock(uint8_t Chan) {
+	IF_myASSERT(debugPARAM, psOWBus != NULL) ;
+	return psOWBus->Lock(Chan) ;
+}
+
+void	OWBusUnlock(void) { psOWBus->Unlock() ; }
+
+// ################################ Generic 1-Wire LINK API's ######################################
+
+/**
+ * Reset all of the devices on the 1-Wire Net and return the result.
+ *
+ * Returns: true(1):  presence pulse(s) detected, device(s) reset
+ *			 false(0): no presence pulses detected
+ */
+int32_t OWReset(void) {
+	IF_myASSERT(debugPARAM, psOWBus != NULL) ;
+	return psOWBus->Reset() ;
+}
+
+/**
+ * Send 1 bit of communication to the 1-Wire Net and return the
+ * result 1 bit read from the 1-Wire Net.
+ *
+ * 'sendbit' - the least significant bit is the bit to send
+ *
+ * Returns: 0:	0 bit read from sendbit
+ *			 1:	1 bit read from sendbit
+ */
+uint8_t OWTouchBit(uint8_t sendbit) {
+	IF_myASSERT(debugPARAM, sendbit < 2) ;
+	return psOWBus->TouchBit(sendbit) ;
+}
+
+void	OWWriteBit(uint8_t sendbit) { OWTouchBit(sendbit) ; }
+
+uint8_t OWReadBit(void) { return OWTouchBit(0x01) ; }
+
+/**
+ * Send 8 bits of communication to the 1-Wire Net, returns once all 8 time slots are done
+ * @return	erSUCCESS or erFAILURE
+ */
+int32_t	OWWriteByte(uint8_t sendbyte) { return psOWBus->WriteByte(sendbyte) ; }
+
+/**
+ * Send 8 bits of read communication to the 1-Wire Net
+ * @return	8 bits read from 1-Wire Net or erFAILURE
+ */
+int32_t	OWReadByte(void) { return psOWBus->ReadByte() ; }
+
+/**
+ * Send 8 bits of communication to the 1-Wire Net and return the
+ * result 8 bits read from the 1-Wire Net.
+ *
+ * 'sendbyte' - 8 bits to send, 0xFF to read
+ *
+ * Returns:  8 bits read from sendbyte
+ */
+uint8_t OWTouchByte(uint8_t sendbyte) {
+	psOWBus->Block(&sendbyte, sizeof(sendbyte)) ;
+	return sendbyte ;
+}
+
+/**
+ * The 'OWBlock' transfers a block of data to and from the
+ * 1-Wire Net. The result is returned in the same buffer.
+ *
+ * 'tran_buf' - pointer to a block of unsigned
+ *				  chars of length 'tran_len' that will be sent
+ *				  to the 1-Wire Net
+ * 'tran_len' - length in bytes to transfer
+ */
+void	OWBlock(uint8_t * tran_buf, int32_t tran_len) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(tran_buf) && tran_len > 0) ;
+	int32_t	iRV = psOWBus->Block(tran_buf, tran_len) ;
+	IF_myASSERT(debugRESULT, iRV == tran_len) ;
+}
+
+/**
+ * OWSearchInit() - prepare a search context
+ * @param	psS		caller owned context
+ * @param	Chan	channel to search
+ * @param	Family	0 for all devices, else start with the first device of this family
+ */
+void	OWSearchInit(ow_search_t * psS, uint8_t Chan, uint8_t Family) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psS)) ;
+	memset(psS, 0, sizeof(ow_search_t)) ;
+	psS->Chan = Chan ;
+	if (Family) {										// target setup
+		psS->ROM.Family			= Family ;
+		psS->LastDiscrepancy	= 64 ;
+	}
+}
+
+/**
+ * OWSearchNext() - find the next device, the bus is locked for the duration
+ * @param	psS		caller owned context, see OWSearchInit()
+ * @return	1 if a device was found and its ROM placed in psS->ROM
+ * 			0 if no (more) devices, the context is then reset for a new search
+ * 			erFAILURE on a bus master failure
+ */
+int32_t OWSearchNext(ow_search_t * psS) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psS)) ;
+	return psOWBus->Search(psS) ;
+}
+
+#endif
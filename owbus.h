@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owbus.h - 1-Wire transport abstraction
+ */
+
+#pragma		once
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ######################################### Structures ############################################
+
+/* One set of 1-Wire primitives per bus master. The DS2482/DS2484 (I2C) provides ds2482Bus, the
+ * DS2480B (UART) ds2480bBus. A caller holds Lock() for the whole exchange, reset to last byte,
+ * only Search() takes the lock itself. */
+typedef struct ow_bus_t {
+	const char *	pName ;
+	int32_t	(*Lock)(uint8_t Chan) ;						// erSUCCESS, else lock NOT held
+	void	(*Unlock)(void) ;
+	int32_t	(*Reset)(void) ;							// 1=presence, 0=none, erFAILURE
+	uint8_t	(*TouchBit)(uint8_t Bit) ;
+	int32_t	(*WriteByte)(uint8_t Byte) ;				// erSUCCESS or erFAILURE, once sent
+	int32_t	(*ReadByte)(void) ;							// 0->255 or erFAILURE
+	int32_t	(*Block)(uint8_t * pBuf, int32_t Len) ;		// write & read back in place
+	int32_t	(*Search)(ow_search_t * psS) ;				// 1=found, 0=no more, erFAILURE
+} ow_bus_t ;
+
+// #################################### Public Data structures #####################################
+
+extern const ow_bus_t * psOWBus ;
+
+// ###################################### Private functions ########################################
+
+void	OWBusSelect(const ow_bus_t * psBus) ;
+int32_t	OWBusLock(uint8_t Chan) ;
+void	OWBusUnlock(void) ;
+
+int32_t OWReset(void) ;
+uint8_t OWTouchBit(uint8_t sendbit) ;
+void	OWWriteBit(uint8_t sendbit) ;
+uint8_t OWReadBit(void) ;
+int32_t	OWWriteByte(uint8_t sendbyte) ;
+int32_t	OWReadByte(void) ;
+uint8_t OWTouchByte(uint8_t sendbyte) ;
+void	OWBlock(uint8_t * tran_buf, int32_t tran_len) ;
+void	OWSearchInit(ow_search_t * psS, uint8_t Chan, uint8_t Family) ;
+int32_t OWSearchNext(ow_search_t * psS) ;
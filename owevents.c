@@ -0,0 +1,152 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owevents.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"owevents.h"
+#include	"ds2482.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+#include	"systiming.h"
+
+#include	"hal_debug.h"
+
+#include	<stdatomic.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Bounded multi-producer/multi-consumer queue (D. Vyukov) with a sequence number per slot.
+ * A producer claims a slot by advancing EnqPos with CAS, copies the event in and only then
+ * publishes the slot by releasing Seq. A consumer claims by advancing DeqPos the same way.
+ * No locks are taken so handlers running in the scan task (or ISR's) can never block, and
+ * each event carries its own copy of the ROM so later searches can not overwrite it. */
+
+DUMB_STATIC_ASSERT((owEVENT_QUEUE_SIZE & (owEVENT_QUEUE_SIZE - 1)) == 0) ;
+
+typedef struct {
+	atomic_uint	Seq ;
+	ow_event_t	sEvent ;
+} ow_evtslot_t ;
+
+static	ow_evtslot_t	sEvtQueue[owEVENT_QUEUE_SIZE] ;
+static	atomic_uint		EnqPos ;
+static	atomic_uint		DeqPos ;
+static	atomic_uint		Dropped ;
+
+// ################################# Application support functions #################################
+
+void	OWEventInit(void) {
+	for (uint32_t i = 0; i < owEVENT_QUEUE_SIZE; ++i) {
+		atomic_store_explicit(&sEvtQueue[i].Seq, i, memory_order_relaxed) ;
+	}
+	atomic_store_explicit(&EnqPos, 0, memory_order_relaxed) ;
+	atomic_store_explicit(&DeqPos, 0, memory_order_relaxed) ;
+	atomic_store_explicit(&Dropped, 0, memory_order_release) ;
+}
+
+/**
+ * OWEventPost() - add an event to the queue, never blocks
+ * @param	Type		owEVT_????
+ * @param	PhyChan		physical channel the event relates to
+ * @param	ROM			ROM to copy into the event, by value as mostly a packed member
+ * @param	Access		owACCESS_???? decision already made for the ROM
+ * @return	erSUCCESS or erFAILURE if the queue was full (event counted as dropped)
+ */
+int32_t	OWEventPost(uint8_t Type, uint8_t PhyChan, ow_rom_t ROM, uint8_t Access) {
+	IF_myASSERT(debugPARAM, Type < owEVT_NUM) ;
+	ow_evtslot_t * psSlot ;
+	uint32_t Pos = atomic_load_explicit(&EnqPos, memory_order_relaxed) ;
+	for (;;) {
+		psSlot = &sEvtQueue[Pos & (owEVENT_QUEUE_SIZE - 1)] ;
+		uint32_t Seq = atomic_load_explicit(&psSlot->Seq, memory_order_acquire) ;
+		int32_t	Dif = (int32_t) Seq - (int32_t) Pos ;
+		if (Dif == 0) {
+			if (atomic_compare_exchange_weak_explicit(&EnqPos, &Pos, Pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+				break ;
+			}
+		} else if (Dif < 0) {							// full, consumer is behind
+			atomic_fetch_add_explicit(&Dropped, 1, memory_order_relaxed) ;
+			return erFAILURE ;
+		} else {
+			Pos = atomic_load_explicit(&EnqPos, memory_order_relaxed) ;
+		}
+	}
+	psSlot->sEvent.usecs	= sTSZ.usecs ;
+	psSlot->sEvent.ROM.Value= ROM.Value ;
+	psSlot->sEvent.Bridge	= sDS2482.sI2Cdev.addrI2C - ds2482ADDR_0 ;
+	psSlot->sEvent.Chan		= PhyChan ;
+	psSlot->sEvent.Type		= Type ;
+	psSlot->sEvent.Access	= Access ;
+	atomic_store_explicit(&psSlot->Seq, Pos + 1, memory_order_release) ;
+	return erSUCCESS ;
+}
+
+/**
+ * OWEventDrain() - remove up to Max events from the queue, oldest first
+ * @param	psEvent		buffer to copy events into
+ * @param	Max			size of the buffer in events
+ * @return	number of events copied, 0 if the queue was empty
+ */
+size_t	OWEventDrain(ow_event_t * psEvent, size_t Max) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psEvent)) ;
+	size_t	Count = 0 ;
+	while (Count < Max) {
+		ow_evtslot_t * psSlot ;
+		uint32_t Pos = atomic_load_explicit(&DeqPos, memory_order_relaxed) ;
+		for (;;) {
+			psSlot = &sEvtQueue[Pos & (owEVENT_QUEUE_SIZE - 1)] ;
+			uint32_t Seq = atomic_load_explicit(&psSlot->Seq, memory_order_acquire) ;
+			int32_t	Dif = (int32_t) Seq - (int32_t) (Pos + 1) ;
+			if (Dif == 0) {
+				if (atomic_compare_exchange_weak_explicit(&DeqPos, &Pos, Pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+					break ;
+				}
+			} else if (Dif < 0) {						// empty
+				return Count ;
+			} else {
+				Pos = atomic_load_explicit(&DeqPos, memory_order_relaxed) ;
+			}
+		}
+		memcpy(&psEvent[Count++], &psSlot->sEvent, sizeof(ow_event_t)) ;
+		atomic_store_explicit(&psSlot->Seq, Pos + owEVENT_QUEUE_SIZE, memory_order_release) ;
+	}
+	return Count ;
+}
+
+size_t	OWEventPending(void) {
+	return atomic_load_explicit(&EnqPos, memory_order_relaxed) - atomic_load_explicit(&DeqPos, memory_order_relaxed) ;
+}
+
+uint32_t OWEventDropped(void) { return atomic_load_explicit(&Dropped, memory_order_relaxed) ; }
+
+#endif
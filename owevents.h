@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owevents.h
+ */
+
+#pragma		once
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+#include	<stddef.h>
+
+// ############################################# Macros ############################################
+
+#define	owEVENT_QUEUE_SIZE					32			// MUST be a power of 2
+
+// ######################################## Enumerations ###########################################
+
+enum {													// Event types
+	owEVT_ARRIVE,										// new device (iButton) read on a channel
+	owEVT_DEPART,										// device no longer present on a channel
+	owEVT_READERR,										// ROM read failed (CRC) during a scan
+	owEVT_NUM,
+} ;
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {
+	uint64_t	usecs ;									// timestamp when the event was posted
+	ow_rom_t	ROM ;									// ROM of the device concerned
+	uint8_t		Bridge ;								// bridge (I2C address offset) number
+	uint8_t		Chan ;									// physical 1-Wire channel, see OWremapTable[]
+	uint8_t		Type ;									// owEVT_????
+	uint8_t		Access ;								// owACCESS_???? decision (ROM index)
+} ow_event_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ow_event_t) == 20) ;
+
+// ###################################### Private functions ########################################
+
+void	OWEventInit(void) ;
+int32_t	OWEventPost(uint8_t Type, uint8_t PhyChan, ow_rom_t ROM, uint8_t Access) ;
+size_t	OWEventDrain(ow_event_t * psEvent, size_t Max) ;
+size_t	OWEventPending(void) ;
+uint32_t OWEventDropped(void) ;
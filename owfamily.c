@@ -0,0 +1,199 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owfamily.c - 1-Wire family driver registry
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"owfamily.h"
+
+#if		(halHAS_DS1990X == 1)
+	#include	"ds1990x.h"
+#endif
+
+#if		(halHAS_DS18X20 == 1)
+	#include	"ds18x20.h"
+#endif
+
+#if		(halHAS_DS2408 == 1)
+	#include	"ds2408.h"
+#endif
+
+#if		(halHAS_OWMEM == 1)
+	#include	"owmem.h"
+#endif
+
+#if		(halHAS_DS2450 == 1)
+	#include	"ds2450.h"
+#endif
+
+#if		(halHAS_DS2409 == 1)
+	#include	"ds2409.h"
+#endif
+
+#if		(halHAS_OWMEM == 1 && halHAS_OWLOG == 1)
+	#include	"owlog.h"
+#endif
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Dispatch is a single lookup: the family code indexes a 256 byte table holding the (1 based)
+ * position of the driver in a short list, so a 2nd family code for the same driver costs 1 byte.
+ * Families without a driver are remembered in a bitmap, reported the first time only. */
+
+static ow_family_t * OWFamilyDrv[owFAMILY_MAX_DRV] = { 0 } ;
+static uint8_t	OWFamilyIdx[256] = { 0 } ;
+static uint8_t	OWFamilyDrvNum = 0 ;
+static uint32_t	OWFamilyUnknown[256 / 32] = { 0 } ;
+static uint16_t	OWFamilyUnknownCount = 0 ;
+
+// ################################# Application support functions #################################
+
+int32_t	OWFamilyRegister(uint8_t Family, ow_family_t * psDrv) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psDrv)) ;
+	if (OWFamilyIdx[Family]) {
+		SL_ERR("Family 0x%02X already has driver %s", Family, OWFamilyDrv[OWFamilyIdx[Family] - 1]->pName) ;
+		return erFAILURE ;
+	}
+	int32_t	Idx ;
+	for (Idx = 0; Idx < OWFamilyDrvNum && OWFamilyDrv[Idx] != psDrv; ++Idx) ;
+	if (Idx == OWFamilyDrvNum) {
+		if (OWFamilyDrvNum == owFAMILY_MAX_DRV) {
+			SL_ERR("Driver table full") ;
+			return erFAILURE ;
+		}
+		OWFamilyDrv[OWFamilyDrvNum++] = psDrv ;
+	}
+	OWFamilyIdx[Family] = Idx + 1 ;
+	IF_PRINT(debugTRACK, "Family 0x%02X => %s\n", Family, psDrv->pName) ;
+	return erSUCCESS ;
+}
+
+ow_family_t * OWFamilyLookup(uint8_t Family) {
+	return OWFamilyIdx[Family] ? OWFamilyDrv[OWFamilyIdx[Family] - 1] : NULL ;
+}
+
+/**
+ * OWFamilyEnumerate() - account for a device found while counting the bus
+ * @return	>0 if the driver needs bus power to stay on, else 0
+ */
+int32_t	OWFamilyEnumerate(ow_search_t * psS) {
+	ow_family_t * psDrv = OWFamilyLookup(psS->ROM.Family) ;
+	if (psDrv == NULL) {
+		uint32_t Mask = 1UL << (psS->ROM.Family % 32) ;
+		if ((OWFamilyUnknown[psS->ROM.Family / 32] & Mask) == 0) {
+			OWFamilyUnknown[psS->ROM.Family / 32] |= Mask ;
+			++OWFamilyUnknownCount ;
+			SL_WARN("Unsupported 1W family 0x%02X", psS->ROM.Family) ;
+		}
+		return 0 ;
+	}
+	++psDrv->Count ;
+	return psDrv->Enumerate ? psDrv->Enumerate(psS) : 0 ;
+}
+
+int32_t	OWFamilyHandle(uint8_t Family, int32_t iCount, void * pVoid) {
+	ow_family_t * psDrv = OWFamilyLookup(Family) ;
+	return (psDrv && psDrv->Handle) ? psDrv->Handle(iCount, pVoid) : erFAILURE ;
+}
+
+int32_t	OWFamilyDiscover(void) {
+	int32_t	iRV = erSUCCESS ;
+	for (int32_t Idx = 0; Idx < OWFamilyDrvNum; ++Idx) {
+		if (OWFamilyDrv[Idx]->Discover && OWFamilyDrv[Idx]->Discover() != erSUCCESS) {
+			iRV = erFAILURE ;							// carry on with the other drivers
+		}
+	}
+	return iRV ;
+}
+
+int32_t	OWFamilySweep(void * pVoid) {
+	int32_t	iRV = erSUCCESS ;
+	for (int32_t Idx = 0; Idx < OWFamilyDrvNum; ++Idx) {
+		if (OWFamilyDrv[Idx]->Sweep && OWFamilyDrv[Idx]->Count && OWFamilyDrv[Idx]->Sweep(pVoid) != erSUCCESS) {
+			iRV = erFAILURE ;
+		}
+	}
+	return iRV ;
+}
+
+void	OWFamilyTeardown(void) {
+	for (int32_t Idx = 0; Idx < OWFamilyDrvNum; ++Idx) {
+		if (OWFamilyDrv[Idx]->Teardown) {
+			OWFamilyDrv[Idx]->Teardown() ;
+		}
+		OWFamilyDrv[Idx]->Count = 0 ;
+	}
+	memset(OWFamilyUnknown, 0, sizeof(OWFamilyUnknown)) ;
+	OWFamilyUnknownCount = 0 ;
+}
+
+void	OWFamilyReport(void) {
+	for (int32_t Idx = 0; Idx < OWFamilyDrvNum; ++Idx) {
+		PRINT("%s=%u  ", OWFamilyDrv[Idx]->pName, OWFamilyDrv[Idx]->Count) ;
+	}
+	PRINT("Unknown=%u\n", OWFamilyUnknownCount) ;
+}
+
+/**
+ * OWFamilyInit() - register the family drivers built into this configuration
+ * @brief	New drivers add their register call here, ds2482.c is not touched
+ */
+void	OWFamilyInit(void) {
+#if		(halHAS_DS1990X == 1)
+	ds1990xRegister() ;
+#endif
+#if		(halHAS_DS18X20 == 1)
+	ds18x20Register() ;
+#endif
+#if		(halHAS_DS2408 == 1)
+	ds2408Register() ;
+#endif
+#if		(halHAS_OWMEM == 1)
+	OWMemRegister() ;
+#endif
+#if		(halHAS_DS2450 == 1)
+	ds2450Register() ;
+#endif
+#if		(halHAS_DS2409 == 1)
+	ds2409Register() ;
+#endif
+#if		(halHAS_OWMEM == 1 && halHAS_OWLOG == 1)
+	OWLogRegister() ;
+#endif
+}
+
+#endif
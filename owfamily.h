@@ -0,0 +1,60 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owfamily.h - 1-Wire family driver registry
+ */
+
+#pragma		once
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	owFAMILY_MAX_DRV					15			// distinct drivers, index 0 = none
+
+// ######################################### Structures ############################################
+
+/* One per family driver, can serve several family codes (eg DS18S20 0x10 & DS18B20 0x28).
+ * Any callback can be NULL. Registered drivers are called in registration order. */
+typedef struct ow_family_t {
+	const char *	pName ;
+	int32_t	(*Enumerate)(ow_search_t * psS) ;			// device found by the bus count, >0 to keep bus power
+	int32_t	(*Discover)(void) ;							// after the count, allocate & configure
+	int32_t	(*Handle)(int32_t iCount, void * pVoid) ;	// device found by a scan, ROM in sDS2482.ROM
+	int32_t	(*Sweep)(void * pVoid) ;					// periodic sampling work
+	void	(*Teardown)(void) ;							// release all resources, undo Discover
+	void *	pState ;									// driver private state
+	uint16_t	Count ;									// devices enumerated, maintained by the registry
+} ow_family_t ;
+
+// ###################################### Private functions ########################################
+
+void	OWFamilyInit(void) ;
+int32_t	OWFamilyRegister(uint8_t Family, ow_family_t * psDrv) ;
+ow_family_t * OWFamilyLookup(uint8_t Family) ;
+int32_t	OWFamilyEnumerate(ow_search_t * psS) ;
+int32_t	OWFamilyHandle(uint8_t Family, int32_t iCount, void * pVoid) ;
+int32_t	OWFamilyDiscover(void) ;
+int32_t	OWFamilySweep(void * pVoid) ;
+void	OWFamilyTeardown(void) ;
+void	OWFamilyReport(void) ;
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owlog.c - Thermochron & Hygrochron mission log download
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_OWMEM == 1) && (halHAS_OWLOG == 1)
+
+#include	"owlog.h"
+#include	"ds2482.h"
+#include	"owfamily.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdlib.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* The log is read with the CRC16 per page memory reads of owmem.c (at overdrive if possible),
+ * directly into the tail of the caller's sample array and then decoded forward in place, which
+ * is safe since a decoded sample is never longer than its raw form is behind it.
+ * A checkpoint per logger (ROM, mission time stamp, next sample) is advanced after every read,
+ * a download interrupted by removing the button continues from there on the next call. A new
+ * mission (time stamp changed) restarts from its first sample, and samples overwritten by a
+ * rolled over log are skipped. Only temperature logs are decoded, samples in 1/256 degree C. */
+
+typedef struct {
+	uint8_t		Family ;
+	uint8_t		Stamp ;									// offsets in the register pages
+	uint8_t		StampLen ;
+	uint8_t		Counter ;								// mission samples, 3 bytes
+	uint8_t		Control ;								// mission control, 0 = none
+	uint16_t	Log ;
+	uint16_t	LogSize ;
+	int16_t		Offset ;								// degrees at raw 0
+} owlog_type_t ;
+
+static const owlog_type_t	sOWLogTypes[] = {
+	{ OWFAMILY_21,	0x15,	5,	0x1A,	0x00,	0x1000,	2048,	-40 },	// DS1921G
+	{ OWFAMILY_41,	0x19,	6,	0x20,	0x13,	0x1000,	8192,	-41 },	// DS1922L/DS1923
+} ;
+
+#define	owLOG_CTRL_ETL				0x01				// temperature logging
+#define	owLOG_CTRL_EHL				0x02				// humidity logging
+#define	owLOG_CTRL_TLFS				0x04				// 16 bit temperature samples
+
+ow_mem_t *	psOWLog			= NULL ;
+uint8_t		OWLogCount		= 0 ;
+static	uint8_t	EnumIdx		= 0 ;
+static	owlog_ckpt_t	sOWLogCkpt[owLOG_CKPT_MAX] ;
+static	uint8_t	CkptNext	= 0 ;						// round robin replacement
+
+// ####################################### Local functions #########################################
+
+static const owlog_type_t * OWLogType(ow_mem_t * psLog) {
+	return &sOWLogTypes[(psLog->ROM.Family == OWFAMILY_21) ? 0 : 1] ;
+}
+
+static owlog_ckpt_t * OWLogCkpt(ow_rom_t ROM) {
+	for (int32_t Idx = 0; Idx < owLOG_CKPT_MAX; ++Idx) {
+		if (sOWLogCkpt[Idx].ROM.Value == ROM.Value) {
+			return &sOWLogCkpt[Idx] ;
+		}
+	}
+	owlog_ckpt_t * psCkpt = &sOWLogCkpt[CkptNext] ;
+	CkptNext = (CkptNext + 1) % owLOG_CKPT_MAX ;
+	memset(psCkpt, 0, sizeof(owlog_ckpt_t)) ;
+	psCkpt->ROM.Value = ROM.Value ;
+	return psCkpt ;
+}
+
+// ################################### Global/public functions #####################################
+
+/**
+ * OWLogDownload() - download the next part of the mission log
+ * @param	pSample		receives up to Max samples, 1/256 degree C
+ * @param	pFirst		receives the mission sample number of pSample[0]
+ * @return	samples placed in pSample, 0 when the log is complete, erFAILURE if the registers
+ * 			could not be read or the log format is not supported
+ */
+int32_t	OWLogDownload(ow_mem_t * psLog, int16_t * pSample, int32_t Max, uint32_t * pFirst) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psLog) && INRANGE_SRAM(pSample) && INRANGE_SRAM(pFirst)) ;
+	const owlog_type_t * psT = OWLogType(psLog) ;
+	uint8_t	Reg[owLOG_REGS_LEN] ;
+	if (OWMemRead(psLog, owLOG_REGS, Reg, sizeof(Reg)) != sizeof(Reg)) {
+		return erFAILURE ;
+	}
+	uint8_t	Control = psT->Control ? Reg[psT->Control] : owLOG_CTRL_ETL ;
+	if ((Control & owLOG_CTRL_EHL) || (Control & owLOG_CTRL_ETL) == 0) {
+		SL_WARN("%#M: log format %02X not supported", psLog->ROM.TagNum, Control) ;
+		return erFAILURE ;
+	}
+	int32_t	Bytes = (Control & owLOG_CTRL_TLFS) ? 2 : 1 ;
+	uint32_t Capacity = psT->LogSize / Bytes ;
+	uint32_t Count = Reg[psT->Counter] | (Reg[psT->Counter + 1] << 8) | (Reg[psT->Counter + 2] << 16) ;
+	uint16_t Stamp = OWCalcCRC16(0, &Reg[psT->Stamp], psT->StampLen) ;
+
+	owlog_ckpt_t * psCkpt = OWLogCkpt(psLog->ROM) ;
+	if (psCkpt->Stamp != Stamp || psCkpt->Next > Count) {	// new mission, start over
+		psCkpt->Stamp	= Stamp ;
+		psCkpt->Next	= 0 ;
+	}
+	if ((Count - psCkpt->Next) > Capacity) {			// rolled over, oldest samples are gone
+		psCkpt->Next	= Count - Capacity ;
+	}
+	int32_t	Todo = ((Count - psCkpt->Next) < Max) ? (Count - psCkpt->Next) : Max ;
+	*pFirst = psCkpt->Next ;
+	int32_t	Got = 0 ;
+	while (Got < Todo) {
+		uint32_t Pos = (psCkpt->Next % Capacity) ;
+		int32_t	Run = ((Capacity - Pos) < (Todo - Got)) ? (Capacity - Pos) : (Todo - Got) ;	// to the log end
+		int16_t * pOut = pSample + Got ;
+		uint8_t * pRaw = (uint8_t *) pOut + (Run * (sizeof(int16_t) - Bytes)) ;
+		int32_t	iRV = OWMemRead(psLog, psT->Log + (Pos * Bytes), pRaw, Run * Bytes) ;
+		int32_t	Done = iRV / Bytes ;					// complete samples only
+		for (int32_t i = 0; i < Done; ++i) {
+			int32_t	Raw = (Bytes == 2) ? (((pRaw[i * 2] << 8) | pRaw[i * 2 + 1]) >> 1) : (pRaw[i] << 7) ;
+			pOut[i] = Raw + (psT->Offset * 256) ;		// raw LSB = 1/512 (16 bit) or 1/2 degree
+		}
+		Got += Done ;
+		psCkpt->Next += Done ;							// checkpoint, resume point if pulled
+		if (Done < Run) {
+			break ;
+		}
+	}
+	IF_PRINT(debugTRACK, "%#M: %u/%u samples\n", psLog->ROM.TagNum, psCkpt->Next, Count) ;
+	return Got ;
+}
+
+/**
+ * OWLogRestart() - forget the checkpoint, the next download starts at the first sample
+ */
+void	OWLogRestart(ow_mem_t * psLog) { OWLogCkpt(psLog->ROM)->Next = 0 ; }
+
+// ################################ Family driver registry support #################################
+
+static int32_t	OWLogHandleEnumerate(int32_t iCount, void * pVoid) {
+	ow_mem_t * psLog = &psOWLog[EnumIdx++] ;
+	memcpy(&psLog->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
+	psLog->Ch	= sDS2482.CurChan ;
+	psLog->Type	= OWMemTypeFind(sDS2482.ROM.Family) ;
+	IF_EXEC_1(debugTRACK, ds2482PrintROM, psLog->ROM) ;
+	return erSUCCESS ;
+}
+
+static int32_t	OWLogEnumerate(ow_search_t * psS) {
+	++OWLogCount ;
+	return 0 ;
+}
+
+static int32_t	OWLogDiscover(void) {
+	if (OWLogCount == 0) {
+		return erSUCCESS ;
+	}
+	psOWLog = malloc(OWLogCount * sizeof(ow_mem_t)) ;
+	IF_myASSERT(debugRESULT, INRANGE_SRAM(psOWLog)) ;
+	memset(psOWLog, 0, OWLogCount * sizeof(ow_mem_t)) ;
+	EnumIdx = 0 ;
+	int32_t	iRV = ds2482ScanAllChannels(OWFAMILY_21, OWLogHandleEnumerate, NULL) ;
+	iRV += ds2482ScanAllChannels(OWFAMILY_41, OWLogHandleEnumerate, NULL) ;
+	IF_PRINT(debugTRACK, "Logger Count=%d\n", OWLogCount) ;
+	if (iRV != OWLogCount) {
+		SL_ERR("Only %d/%d enumerated!!!", iRV, OWLogCount) ;
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static void	OWLogTeardown(void) {
+	free(psOWLog) ;										// checkpoints are kept
+	psOWLog		= NULL ;
+	OWLogCount	= 0 ;
+}
+
+static ow_family_t	sOWLogDrv = {
+	.pName		= "Logger",
+	.Enumerate	= OWLogEnumerate,
+	.Discover	= OWLogDiscover,
+	.Teardown	= OWLogTeardown,
+} ;
+
+void	OWLogRegister(void) {
+	OWFamilyRegister(OWFAMILY_21, &sOWLogDrv) ;
+	OWFamilyRegister(OWFAMILY_41, &sOWLogDrv) ;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owlog.h - Thermochron & Hygrochron mission log download
+ */
+
+#pragma		once
+
+#include	"x_definitions.h"
+
+#include	"owmem.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	owLOG_CKPT_MAX						8			// loggers with a download checkpoint
+#define	owLOG_REGS							0x0200		// register pages, read in one go
+#define	owLOG_REGS_LEN						64
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {				// download checkpoint, survives re-enumeration
+	ow_rom_t	ROM ;
+	uint16_t	Stamp ;									// CRC16 of the mission start time stamp
+	uint32_t	Next ;									// next mission sample to download
+} owlog_ckpt_t ;
+
+DUMB_STATIC_ASSERT(sizeof(owlog_ckpt_t) == 14) ;
+
+// #################################### Public Data structures #####################################
+
+extern uint8_t OWLogCount ;
+extern ow_mem_t * psOWLog ;
+
+// ###################################### Private functions ########################################
+
+int32_t	OWLogDownload(ow_mem_t * psLog, int16_t * pSample, int32_t Max, uint32_t * pFirst) ;
+void	OWLogRestart(ow_mem_t * psLog) ;
+void	OWLogRegister(void) ;
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owmem.c - 1-Wire EEPROM & NV RAM memory devices
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1) && (halHAS_OWMEM == 1)
+
+#include	"owmem.h"
+#include	"ds2482.h"
+#include	"ds2482arb.h"
+#include	"ds2482health.h"
+#include	"ds2482stats.h"
+#include	"owfamily.h"
+#include	"owpolicy.h"
+#include	"owxact.h"
+#include	"ds2409.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdlib.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Reads stream straight from the bridge into the caller's buffer, one addressed session for the
+ * whole range, instead of a byte level OWBlock() per chunk. A session that fails (bus error or
+ * CRC16) is restarted at the first page not yet verified, a session that made progress restarts
+ * the owOP_MEMORY retry count. Plain Read Memory has no CRC, only owMEM_EXT_READ and
+ * owMEM_READ_PW pages are verified on the wire. Types with owMEM_OVERDRIVE are addressed with
+ * Overdrive Match ROM and read at overdrive, a failed overdrive session drops the rest of the
+ * read back to standard speed.
+ * Writes always use complete scratchpad rows (partial rows are read & merged first), so every
+ * write/read scratchpad ends at the row end where the CRC16 (if any) is available:
+ *	Write SP [TA1 TA2 data] (CRC16) -> Read SP [TA1 TA2 E/S data] (CRC16) -> Copy SP [TA1 TA2 E/S]
+ *	-> tPROG with strong pullup -> 0xAA */
+
+static const ow_mem_type_t	sOWMemTypes[] = {
+	{ OWFAMILY_2D, owMEM_EEPROM | owMEM_SP_CRC,					8,	32,	4,		10 },	// DS2431
+	{ OWFAMILY_23, owMEM_EEPROM | owMEM_SP_CRC,					32,	32,	16,		5 },	// DS2433
+	{ OWFAMILY_43, owMEM_EEPROM | owMEM_SP_CRC | owMEM_EXT_READ,	32,	32,	80,		10 },	// DS28EC20
+	{ OWFAMILY_0C, 0,											32,	32,	256,	0 },	// DS1996
+	{ OWFAMILY_06, 0,											32,	32,	16,		0 },	// DS1993
+	{ OWFAMILY_08, 0,											32,	32,	4,		0 },	// DS1992
+	{ OWFAMILY_21, owMEM_LOGGER | owMEM_EXT_READ | owMEM_OVERDRIVE,	32,	32,	192,	0 },	// DS1921
+	{ OWFAMILY_41, owMEM_LOGGER | owMEM_READ_PW | owMEM_OVERDRIVE,	32,	32,	384,	0 },	// DS1922/3
+} ;
+
+#define	owMEM_TYPES					(sizeof(sOWMemTypes) / sizeof(sOWMemTypes[0]))
+
+ow_mem_t *	psOWMem			= NULL ;
+uint8_t		OWMemCount		= 0 ;
+static	uint8_t	EnumIdx		= 0 ;
+static	uint8_t	OWMemPassword[owMEM_PW_LEN]	= { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } ;
+
+// ####################################### Local functions #########################################
+
+static int32_t	OWMemSession(ow_mem_t * psMem, uint8_t Flags, uint8_t Cmd, uint8_t * pTx, uint8_t TxLen) {
+	ow_rom_t	sROM = psMem->ROM ;
+	ow_xact_t	sXact = {
+		.psROM = &sROM,	.pTx = pTx,		.Chan = psMem->Ch,		.Cmd = Cmd,		.TxLen = TxLen,
+#if 	(ds2482SINGLE_DEVICE == 0)
+		.Flags = Flags | owXACT_CHAN | owXACT_RESET | owXACT_MATCH,
+#else
+		.Flags = Flags | owXACT_CHAN | owXACT_RESET | owXACT_SKIP,
+#endif
+	} ;
+	return OWXactRun(&sXact) ;
+}
+
+/**
+ * OWMemSessionOD() - Overdrive Match ROM then the function command, all at overdrive speed
+ * @brief	Caller holds the bridge and must return the bus to standard speed afterwards
+ */
+static int32_t	OWMemSessionOD(ow_mem_t * psMem, uint8_t Cmd, uint8_t * pTx, uint8_t TxLen) {
+#if		(halHAS_DS2409 == 1)
+	if (ds2409Select(psMem->Ch, ds2409Route(psMem->ROM)) != erSUCCESS) {
+		return erFAILURE ;
+	}
+#endif
+	ow_xact_t	sXact = {
+		.Chan = psMem->Ch,	.Cmd = OW_CMD_MATCHROM_OD,	.Flags = owXACT_CHAN | owXACT_RESET,
+	} ;
+	int32_t	iRV = OWXactRun(&sXact) ;					// command at standard speed
+	if (iRV != 1) {
+		return iRV ;
+	}
+	OWSpeed(owMODE_OVERDRIVE) ;
+	for (int32_t i = 0; i < ONEWIRE_ROM_LENGTH; ++i) {
+		iRV = ds2482XactWriteByte(psMem->ROM.HexChars[i]) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+	}
+	iRV = ds2482XactWriteByte(Cmd) ;
+	for (int32_t i = 0; iRV == erSUCCESS && i < TxLen; ++i) {
+		iRV = ds2482XactWriteByte(pTx[i]) ;
+	}
+	return (iRV == erSUCCESS) ? 1 : iRV ;
+}
+
+/**
+ * OWMemCheckCRC16() - read the inverted CRC16 (LSB first) sent by the device and compare
+ * @return	1 if matched, 0 if not, erFAILURE if the bridge failed
+ */
+static int32_t	OWMemCheckCRC16(uint16_t crc16) {
+	int32_t	Lsb = ds2482XactReadByte() ;
+	int32_t	Msb = ds2482XactReadByte() ;
+	if (Lsb < 0 || Msb < 0) {
+		return erFAILURE ;
+	}
+	return ((crc16 ^ 0xFFFF) == ((Msb << 8) | Lsb)) ? 1 : 0 ;
+}
+
+/**
+ * OWMemReadRun() - one Read Memory session from Addr
+ * @return	number of bytes read and verified, always ending on a page boundary or at Len
+ */
+static int32_t	OWMemReadRun(ow_mem_t * psMem, uint16_t Addr, uint8_t * pBuf, int32_t Len, int32_t OD) {
+	const ow_mem_type_t * psT = &sOWMemTypes[psMem->Type] ;
+	int32_t	Ext = psT->Flags & (owMEM_EXT_READ | owMEM_READ_PW) ;
+	uint8_t	Cmd = (psT->Flags & owMEM_READ_PW) ? OWMEM_READ_PW : Ext ? OWMEM_READ_EXT : OWMEM_READ ;
+	uint8_t	Tx[2 + owMEM_PW_LEN + 1] = { Addr & 0xFF, Addr >> 8 } ;	// TA1 TA2 [password 0xFF]
+	uint8_t	TxLen = 2 ;
+	if (psT->Flags & owMEM_READ_PW) {					// not included in the CRC16
+		memcpy(&Tx[TxLen], OWMemPassword, owMEM_PW_LEN) ;
+		TxLen += owMEM_PW_LEN ;
+		Tx[TxLen++] = 0xFF ;
+	}
+	ds2482ArbAcquire(ds2482PRIO_ENUM) ;					// bulk transfer, others go first
+	if (ds2482Lock(psMem->Ch) != erSUCCESS) {			// held between the session & the data
+		ds2482ArbRelease() ;
+		return 0 ;
+	}
+	int32_t	Idx = 0, Good = 0 ;
+	if ((OD ? OWMemSessionOD(psMem, Cmd, Tx, TxLen) : OWMemSession(psMem, 0, Cmd, Tx, TxLen)) == 1) {
+		uint16_t crc16 = OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), Tx, 2) ;
+		uint32_t Next = Addr ;
+		while (Good < Len) {
+			int32_t	Byte = ds2482XactReadByte() ;
+			if (Byte < 0) {
+				break ;
+			}
+			uint8_t	Data = Byte ;
+			if (Idx < Len) {
+				pBuf[Idx++] = Data ;					// beyond Len only to reach the page CRC
+			}
+			if (Ext) {
+				crc16 = OWCalcCRC16(crc16, &Data, sizeof(Data)) ;
+			}
+			if ((++Next % psT->PageSize) != 0) {
+				if (Ext || Idx < Len) {
+					continue ;
+				}
+				Good = Idx ;							// plain read, Len ends mid page
+				break ;
+			}
+			if (Ext && OWMemCheckCRC16(crc16) != 1) {
+				ds2482STAT_INC(CRCfail) ;
+				break ;
+			}
+			crc16 = 0 ;									// later pages exclude cmd & address
+			Good = Idx ;
+		}
+	}
+	if (OD) {											// standard speed reset, all devices back
+		OWSpeed(owMODE_STANDARD) ;
+		ds2482OWReset() ;
+	}
+	ds2482Unlock() ;
+	ds2482ArbRelease() ;
+	return Good ;
+}
+
+/**
+ * OWMemWriteRow() - write, verify & copy one complete scratchpad row
+ * @return	1 if copied, 0 if no presence or verification failed, erFAILURE
+ */
+static int32_t	OWMemWriteRow(ow_mem_t * psMem, uint16_t Addr, const uint8_t * pRow) {
+	const ow_mem_type_t * psT = &sOWMemTypes[psMem->Type] ;
+	uint8_t	Buf[3 + owMEM_SP_MAX] ;						// TA1 TA2 [E/S] data
+	uint8_t	Cmd ;
+	Buf[0] = Addr & 0xFF ;
+	Buf[1] = Addr >> 8 ;
+	memcpy(&Buf[2], pRow, psT->SpSize) ;
+	ds2482ArbAcquire(ds2482PRIO_ENUM) ;
+	if (ds2482Lock(psMem->Ch) != erSUCCESS) {
+		ds2482ArbRelease() ;
+		return erFAILURE ;
+	}
+	// Write scratchpad, inverted CRC16 over cmd, TA & data
+	int32_t	iRV = OWMemSession(psMem, 0, OWMEM_WRITE_SP, Buf, 2 + psT->SpSize) ;
+	if (iRV == 1 && (psT->Flags & owMEM_SP_CRC)) {
+		Cmd = OWMEM_WRITE_SP ;
+		iRV = OWMemCheckCRC16(OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), Buf, 2 + psT->SpSize)) ;
+	}
+
+	// Read scratchpad back, address, E/S and data must match
+	if (iRV == 1) {
+		iRV = OWMemSession(psMem, 0, OWMEM_READ_SP, NULL, 0) ;
+	}
+	for (int32_t i = 0; iRV == 1 && i < (3 + psT->SpSize); ++i) {
+		iRV = ds2482XactReadByte() ;
+		if (iRV >= 0) {
+			Buf[i] = iRV ;
+			iRV = 1 ;
+		}
+	}
+	if (iRV == 1 && (psT->Flags & owMEM_SP_CRC)) {
+		Cmd = OWMEM_READ_SP ;
+		iRV = OWMemCheckCRC16(OWCalcCRC16(OWCalcCRC16(0, &Cmd, sizeof(Cmd)), Buf, 3 + psT->SpSize)) ;
+	}
+	if (iRV == 1 && (Buf[0] != (Addr & 0xFF) || Buf[1] != (Addr >> 8) || (Buf[2] & OWMEM_ES_PF) ||
+			(Buf[2] & 0x1F) != (psT->SpSize - 1) || memcmp(&Buf[3], pRow, psT->SpSize) != 0)) {
+		IF_PRINT(debugRESULT, "SP verify: %-'+b\n", 3 + psT->SpSize, Buf) ;
+		iRV = 0 ;
+	}
+
+	// Copy scratchpad, authorised by TA1 TA2 E/S as read back
+	if (iRV == 1) {
+		iRV = OWMemSession(psMem, (psT->Flags & owMEM_EEPROM) ? owXACT_POWER : 0, OWMEM_COPY_SP, Buf, 3) ;
+		if (psT->tPROG) {
+			vTaskDelay(pdMS_TO_TICKS(psT->tPROG)) ;	// SPU on, lock held
+		}
+		if (psT->Flags & owMEM_EEPROM) {
+			OWLevel(owMODE_STANDARD) ;					// make SPU=0
+		}
+		if (iRV == 1) {
+			iRV = ds2482XactReadByte() ;
+			iRV = (iRV == OWMEM_COPY_ACK) ? 1 : (iRV < 0) ? erFAILURE : 0 ;
+		}
+	}
+	ds2482Unlock() ;
+	ds2482ArbRelease() ;
+	return iRV ;
+}
+
+// ################################### Global/public functions #####################################
+
+const ow_mem_type_t * OWMemType(ow_mem_t * psMem) { return &sOWMemTypes[psMem->Type] ; }
+
+int32_t	OWMemTypeFind(uint8_t Family) {
+	for (int32_t Type = 0; Type < owMEM_TYPES; ++Type) {
+		if (sOWMemTypes[Type].Family == Family) {
+			return Type ;
+		}
+	}
+	return erFAILURE ;
+}
+
+/**
+ * OWMemSetPassword() - read access password for owMEM_READ_PW types, all 0xFF by default
+ */
+void	OWMemSetPassword(const uint8_t * pPW) { memcpy(OWMemPassword, pPW, owMEM_PW_LEN) ; }
+
+uint32_t OWMemSize(ow_mem_t * psMem) {
+	return (uint32_t) sOWMemTypes[psMem->Type].PageSize * sOWMemTypes[psMem->Type].Pages ;
+}
+
+/**
+ * OWMemRead() - read a memory range directly into the caller's buffer
+ * @return	number of bytes read (Len if complete), a partial count if the retries ran out
+ */
+int32_t	OWMemRead(ow_mem_t * psMem, uint16_t Addr, uint8_t * pBuf, int32_t Len) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psMem) && INRANGE_SRAM(pBuf) && (Addr + Len) <= OWMemSize(psMem)) ;
+	ow_retry_t sRetry ;
+	OWRetryStart(&sRetry, owOP_MEMORY, psMem->Ch) ;
+	int32_t	OD = (owMEM_OD_ENABLE && (sOWMemTypes[psMem->Type].Flags & owMEM_OVERDRIVE)) ? 1 : 0 ;
+	int32_t	Done = 0 ;
+	while (Done < Len) {
+		int32_t	iRV = OWMemReadRun(psMem, Addr + Done, pBuf + Done, Len - Done, OD) ;
+		if (iRV > 0) {									// progress, fresh retry budget
+			Done += iRV ;
+			OWRetryStart(&sRetry, owOP_MEMORY, psMem->Ch) ;
+		} else if (OWRetryNext(&sRetry) == 0) {
+			break ;
+		} else {
+			OD = 0 ;									// cable too long/loaded for overdrive?
+		}
+	}
+	ds2482HealthUpdate(psMem->Ch, Done == Len) ;
+	IF_SL_ERR(Done < Len, "Read %d/%d from 0x%04X", Done, Len, Addr) ;
+	return Done ;
+}
+
+/**
+ * OWMemWrite() - write a memory range through the scratchpad, each row verified before copy
+ * @return	number of bytes written (Len if complete), a partial count (at a row boundary relative
+ * 			to the first row written) if the retries ran out, or erFAILURE if a partial row could
+ * 			not be read for merging
+ */
+int32_t	OWMemWrite(ow_mem_t * psMem, uint16_t Addr, const uint8_t * pBuf, int32_t Len) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psMem) && pBuf != NULL && (Addr + Len) <= OWMemSize(psMem)) ;
+	const ow_mem_type_t * psT = &sOWMemTypes[psMem->Type] ;
+	if (psT->Flags & owMEM_LOGGER) {
+		return erFAILURE ;								// mission memory, read only
+	}
+	uint8_t	Row[owMEM_SP_MAX] ;
+	ow_retry_t sRetry ;
+	int32_t	Done = 0 ;
+	while (Done < Len) {
+		uint16_t RowAddr = (Addr + Done) & ~(psT->SpSize - 1) ;
+		uint8_t	Offset = (Addr + Done) - RowAddr ;
+		int32_t	Count = psT->SpSize - Offset ;
+		if (Count > (Len - Done)) {
+			Count = Len - Done ;
+		}
+		if (Count < psT->SpSize && OWMemRead(psMem, RowAddr, Row, psT->SpSize) != psT->SpSize) {
+			return erFAILURE ;							// partial row, merge with the current data
+		}
+		memcpy(&Row[Offset], pBuf + Done, Count) ;
+		int32_t	iRV ;
+		OWRetryStart(&sRetry, owOP_MEMORY, psMem->Ch) ;
+		do {
+			iRV = OWMemWriteRow(psMem, RowAddr, Row) ;
+		} while (iRV != 1 && OWRetryNext(&sRetry)) ;
+		if (iRV != 1) {
+			break ;
+		}
+		Done += Count ;
+	}
+	ds2482HealthUpdate(psMem->Ch, Done == Len) ;
+	IF_SL_ERR(Done < Len, "Wrote %d/%d at 0x%04X", Done, Len, Addr) ;
+	return Done ;
+}
+
+// ################################ Family driver registry support #################################
+
+static int32_t	OWMemHandleEnumerate(int32_t iCount, void * pVoid) {
+	ow_mem_t * psMem = &psOWMem[EnumIdx++] ;
+	memcpy(&psMem->ROM, &sDS2482.ROM, sizeof(ow_rom_t)) ;
+	psMem->Ch	= sDS2482.CurChan ;
+	psMem->Type	= (uintptr_t) pVoid ;
+	IF_EXEC_1(debugTRACK, ds2482PrintROM, psMem->ROM) ;
+	return erSUCCESS ;
+}
+
+static int32_t	OWMemEnumerate(ow_search_t * psS) {
+	++OWMemCount ;
+	return 0 ;
+}
+
+static int32_t	OWMemDiscover(void) {
+	if (OWMemCount == 0) {
+		return erSUCCESS ;
+	}
+	psOWMem = malloc(OWMemCount * sizeof(ow_mem_t)) ;
+	IF_myASSERT(debugRESULT, INRANGE_SRAM(psOWMem)) ;
+	memset(psOWMem, 0, OWMemCount * sizeof(ow_mem_t)) ;
+	EnumIdx = 0 ;
+	int32_t	iRV = 0 ;
+	for (uintptr_t Type = 0; Type < owMEM_TYPES; ++Type) {
+		if (sOWMemTypes[Type].Flags & owMEM_LOGGER) {
+			continue ;
+		}
+		iRV += ds2482ScanAllChannels(sOWMemTypes[Type].Family, OWMemHandleEnumerate, (void *) Type) ;
+	}
+	IF_PRINT(debugTRACK, "Memory Count=%d\n", OWMemCount) ;
+	if (iRV != OWMemCount) {
+		SL_ERR("Only %d/%d enumerated!!!", iRV, OWMemCount) ;
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static void	OWMemTeardown(void) {
+	free(psOWMem) ;
+	psOWMem		= NULL ;
+	OWMemCount	= 0 ;
+}
+
+static ow_family_t	sOWMemDrv = {
+	.pName		= "Memory",
+	.Enumerate	= OWMemEnumerate,
+	.Discover	= OWMemDiscover,
+	.Teardown	= OWMemTeardown,
+} ;
+
+void	OWMemRegister(void) {
+	for (uint32_t Type = 0; Type < owMEM_TYPES; ++Type) {
+		if ((sOWMemTypes[Type].Flags & owMEM_LOGGER) == 0) {
+			OWFamilyRegister(sOWMemTypes[Type].Family, &sOWMemDrv) ;
+		}
+	}
+}
+
+#endif
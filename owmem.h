@@ -0,0 +1,81 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owmem.h - 1-Wire EEPROM & NV RAM memory devices
+ */
+
+#pragma		once
+
+#include	"x_definitions.h"
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+// Memory type capability flags
+#define	owMEM_EEPROM						0x01		// copy needs strong pullup for tPROG
+#define	owMEM_SP_CRC						0x02		// scratchpad write/read end with inverted CRC16
+#define	owMEM_EXT_READ						0x04		// Extended Read Memory, CRC16 after every page
+#define	owMEM_READ_PW						0x08		// Read Memory with password, CRC16 after every page
+#define	owMEM_OVERDRIVE						0x10		// reads can be done at overdrive speed
+#define	owMEM_LOGGER						0x20		// family owned by owlog.c, read only
+
+#define	owMEM_SP_MAX						32			// largest scratchpad of the supported types
+#define	owMEM_OD_ENABLE						1			// 1=read at overdrive where supported
+#define	owMEM_PW_LEN						8
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {				// memory device type, see owmem.c
+	uint8_t		Family ;
+	uint8_t		Flags ;									// owMEM_????
+	uint8_t		SpSize ;								// scratchpad (write row) size
+	uint8_t		PageSize ;								// Read Memory page size
+	uint16_t	Pages ;
+	uint8_t		tPROG ;									// mS copy time, 0 = NV RAM
+} ow_mem_type_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ow_mem_type_t) == 7) ;
+
+typedef struct __attribute__((packed)) {				// memory device record
+	ow_rom_t	ROM ;
+	uint8_t		Ch		: 3 ;							// Channel the device was discovered on
+	uint8_t		Type	: 5 ;							// index into the type table
+} ow_mem_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ow_mem_t) == 9) ;
+
+// #################################### Public Data structures #####################################
+
+extern uint8_t OWMemCount ;
+extern ow_mem_t * psOWMem ;
+
+// ###################################### Private functions ########################################
+
+const ow_mem_type_t * OWMemType(ow_mem_t * psMem) ;
+int32_t	OWMemTypeFind(uint8_t Family) ;
+void	OWMemSetPassword(const uint8_t * pPW) ;
+uint32_t OWMemSize(ow_mem_t * psMem) ;
+int32_t	OWMemRead(ow_mem_t * psMem, uint16_t Addr, uint8_t * pBuf, int32_t Len) ;
+int32_t	OWMemWrite(ow_mem_t * psMem, uint16_t Addr, const uint8_t * pBuf, int32_t Len) ;
+void	OWMemRegister(void) ;
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owpolicy.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"owpolicy.h"
+
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Retry & backoff policy per operation class, optionally overridden per channel.
+ * Usage:	ow_retry_t sRetry ;
+ *			OWRetryStart(&sRetry, owOP_????, Chan) ;
+ *			do { iRV = attempt() ; } while (iRV fails && OWRetryNext(&sRetry)) ;
+ * OWRetryNext() does the delay (if any) and returns 0 once MaxTry attempts have been made or
+ * the next delay would exceed the time budget, so failure handling stays inside a known bound.
+ * Delays & budgets are rounded up to at least 1 tick, at 100Hz 5mS would otherwise be no delay.
+ * Busy: 1WB is polled back to back, ds2482tPOLL_US per status read, so the attempts must cover
+ * the longest 1-Wire operation, a reset plus a byte (8 slots) with SPU armed, twice over for a
+ * slow or shared I2C bus. */
+
+#define	owBUSY_MAX_US				(2 * (ds2482tRESET_US + (8 * ds2482tSLOT_US)))
+DUMB_STATIC_ASSERT((owBUSY_MAX_US / ds2482tPOLL_US) < 255) ;
+
+static const ow_policy_t sPolicyDefault[owOP_NUM] = {
+	[owOP_RESET]		= { .MaxTry = 2,				.Curve = owBACKOFF_FIXED,	.DelayMs = 0,	.MaxDelayMs = 0,	.BudgetMs = 20 },
+	[owOP_BUSY]			= { .MaxTry = (owBUSY_MAX_US / ds2482tPOLL_US) + 1,	.Curve = owBACKOFF_FIXED,	.DelayMs = 0,	.MaxDelayMs = 0,	.BudgetMs = (owBUSY_MAX_US / 1000) + 1 },
+	[owOP_SEARCH]		= { .MaxTry = 2,				.Curve = owBACKOFF_FIXED,	.DelayMs = 0,	.MaxDelayMs = 0,	.BudgetMs = 100 },
+	[owOP_SCRATCHPAD]	= { .MaxTry = ds2482RETRIES,	.Curve = owBACKOFF_EXP,		.DelayMs = 10,	.MaxDelayMs = 40,	.BudgetMs = 150 },
+	[owOP_READROM]		= { .MaxTry = 3,				.Curve = owBACKOFF_FIXED,	.DelayMs = 5,	.MaxDelayMs = 5,	.BudgetMs = 50 },
+	[owOP_MEMORY]		= { .MaxTry = 3,				.Curve = owBACKOFF_LINEAR,	.DelayMs = 5,	.MaxDelayMs = 20,	.BudgetMs = 200 },
+} ;
+
+static ow_policy_t	sPolicy[owOP_NUM][ds2482NUM_CHAN] ;
+
+// ####################################### Local functions #########################################
+
+static TickType_t OWPolicyTicks(uint32_t Ms) {
+	TickType_t	Ticks = pdMS_TO_TICKS(Ms) ;
+	return (Ms && Ticks == 0) ? 1 : Ticks ;
+}
+
+// ################################# Application support functions #################################
+
+void	OWPolicyInit(void) {
+	for (uint8_t Op = 0; Op < owOP_NUM; ++Op) {
+		OWPolicySet(Op, owPOLICY_ALL_CHAN, &sPolicyDefault[Op]) ;
+	}
+}
+
+/**
+ * OWPolicySet() - change the policy for an operation class
+ * @param	Op			owOP_????
+ * @param	Chan		channel number or owPOLICY_ALL_CHAN
+ * @param	psPol		new policy, NULL to restore the default
+ */
+void	OWPolicySet(uint8_t Op, uint8_t Chan, const ow_policy_t * psPol) {
+	IF_myASSERT(debugPARAM, Op < owOP_NUM && (Chan < ds2482NUM_CHAN || Chan == owPOLICY_ALL_CHAN)) ;
+	if (psPol == NULL) {
+		psPol = &sPolicyDefault[Op] ;
+	}
+	IF_myASSERT(debugPARAM, psPol->MaxTry > 0) ;
+	for (uint8_t Idx = 0; Idx < ds2482NUM_CHAN; ++Idx) {
+		if (Chan == owPOLICY_ALL_CHAN || Chan == Idx) {
+			memcpy(&sPolicy[Op][Idx], psPol, sizeof(ow_policy_t)) ;
+		}
+	}
+}
+
+const ow_policy_t * OWPolicyGet(uint8_t Op, uint8_t Chan) {
+	IF_myASSERT(debugPARAM, Op < owOP_NUM && Chan < ds2482NUM_CHAN) ;
+	return (sPolicy[Op][Chan].MaxTry) ? &sPolicy[Op][Chan] : &sPolicyDefault[Op] ;
+}
+
+void	OWRetryStart(ow_retry_t * psRetry, uint8_t Op, uint8_t Chan) {
+	psRetry->psPol	= OWPolicyGet(Op, Chan) ;
+	psRetry->Start	= xTaskGetTickCount() ;
+	psRetry->Try	= 1 ;								// first attempt about to be made
+}
+
+/**
+ * OWRetryNext() - decide if another attempt is allowed and wait the backoff delay
+ * @return	1 if the caller should try again, 0 if attempts or budget exhausted
+ */
+int32_t	OWRetryNext(ow_retry_t * psRetry) {
+	const ow_policy_t * psPol = psRetry->psPol ;
+	if (psRetry->Try >= psPol->MaxTry) {
+		return 0 ;
+	}
+	uint32_t DelayMs = psPol->DelayMs ;
+	if (psPol->Curve == owBACKOFF_LINEAR) {
+		DelayMs *= psRetry->Try ;
+	} else if (psPol->Curve == owBACKOFF_EXP) {
+		DelayMs <<= (psRetry->Try - 1) ;
+	}
+	if (psPol->MaxDelayMs && DelayMs > psPol->MaxDelayMs) {
+		DelayMs = psPol->MaxDelayMs ;
+	}
+	if (psPol->BudgetMs &&
+		(xTaskGetTickCount() - psRetry->Start + OWPolicyTicks(DelayMs)) > OWPolicyTicks(psPol->BudgetMs)) {
+		return 0 ;										// would exceed the budget
+	}
+	if (DelayMs) {
+		vTaskDelay(OWPolicyTicks(DelayMs)) ;
+	}
+	++psRetry->Try ;
+	return 1 ;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owpolicy.h
+ */
+
+#pragma		once
+
+#include	"ds2482.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	owPOLICY_ALL_CHAN					0xFF		// OWPolicySet() Chan to apply to all channels
+
+// ######################################## Enumerations ###########################################
+
+enum {													// Operation classes, each with own policy
+	owOP_RESET,											// 1-Wire reset, bridge timeout
+	owOP_BUSY,											// polling 1WB in ds2482WaitNotBusy()
+	owOP_SEARCH,										// search pass failed part way
+	owOP_SCRATCHPAD,									// scratchpad read CRC failure
+	owOP_READROM,										// Read ROM CRC failure
+	owOP_MEMORY,										// memory page/row failed, resumed
+	owOP_NUM,
+} ;
+
+enum {													// Backoff curve between attempts
+	owBACKOFF_FIXED,									// Delay
+	owBACKOFF_LINEAR,									// Delay * n
+	owBACKOFF_EXP,										// Delay * 2^(n-1)
+} ;
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) {
+	uint8_t		MaxTry ;								// total attempts, including the first
+	uint8_t		Curve ;									// owBACKOFF_????
+	uint16_t	DelayMs ;								// base delay between attempts
+	uint16_t	MaxDelayMs ;							// cap on a single delay
+	uint16_t	BudgetMs ;								// total time allowed, 0 = unlimited
+} ow_policy_t ;
+
+DUMB_STATIC_ASSERT(sizeof(ow_policy_t) == 8) ;
+
+typedef struct {
+	const ow_policy_t * psPol ;
+	TickType_t	Start ;
+	uint8_t		Try ;									// attempts made so far
+} ow_retry_t ;
+
+// ###################################### Private functions ########################################
+
+void	OWPolicyInit(void) ;
+void	OWPolicySet(uint8_t Op, uint8_t Chan, const ow_policy_t * psPol) ;
+const ow_policy_t * OWPolicyGet(uint8_t Op, uint8_t Chan) ;
+void	OWRetryStart(ow_retry_t * psRetry, uint8_t Op, uint8_t Chan) ;
+int32_t	OWRetryNext(ow_retry_t * psRetry) ;
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owromidx.c
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"owromidx.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#include	<stdlib.h>
+#include	<string.h>
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* ROM whitelist used to grant/deny iButton access directly from the read path.
+ * The ROM values are kept in a statically allocated array, sorted ascending on the 64 bit
+ * ow_rom_t.Value, giving a lookup cost of log2(owROMIDX_MAX) = 11 compares at most.
+ * The optional Bloom filter in front rejects most unknown ROM's after 3 bit tests with
+ * no binary search at all. Add/Remove keep the array sorted (memmove) and are expected to be
+ * infrequent compared to lookups. Removing a key rebuilds the Bloom filter from the array. */
+
+#if		(owROMIDX_BLOOM == 1)
+	DUMB_STATIC_ASSERT((owROMIDX_BLOOM_BITS & (owROMIDX_BLOOM_BITS - 1)) == 0) ;
+	static	uint32_t	BloomBits[owROMIDX_BLOOM_BITS / 32] ;
+#endif
+static	uint64_t		RomIdx[owROMIDX_MAX] ;
+static	size_t			RomCount = 0 ;
+static	SemaphoreHandle_t	RomMux = 0 ;
+
+// ############################### Bloom filter & search support ##################################
+
+#if		(owROMIDX_BLOOM == 1)
+/* ROM's are not uniformly distributed (Family & CRC bytes) so mix all 64 bits first, then
+ * derive the k indices from the 2 halves (Kirsch & Mitzenmacher double hashing) */
+static uint64_t OWRomIdxMix(uint64_t Value) {
+	Value ^= Value >> 33 ;
+	Value *= 0xFF51AFD7ED558CCDULL ;
+	Value ^= Value >> 33 ;
+	Value *= 0xC4CEB9FE1A85EC53ULL ;
+	Value ^= Value >> 33 ;
+	return Value ;
+}
+
+static void OWRomIdxBloomSet(uint64_t Value) {
+	uint64_t Hash = OWRomIdxMix(Value) ;
+	uint32_t H1 = Hash, H2 = Hash >> 32 ;
+	for (uint32_t i = 0; i < owROMIDX_BLOOM_HASHES; ++i) {
+		uint32_t Bit = (H1 + i * H2) & (owROMIDX_BLOOM_BITS - 1) ;
+		BloomBits[Bit / 32] |= 1UL << (Bit % 32) ;
+	}
+}
+
+static int32_t OWRomIdxBloomTest(uint64_t Value) {
+	uint64_t Hash = OWRomIdxMix(Value) ;
+	uint32_t H1 = Hash, H2 = Hash >> 32 ;
+	for (uint32_t i = 0; i < owROMIDX_BLOOM_HASHES; ++i) {
+		uint32_t Bit = (H1 + i * H2) & (owROMIDX_BLOOM_BITS - 1) ;
+		if ((BloomBits[Bit / 32] & (1UL << (Bit % 32))) == 0) {
+			return 0 ;
+		}
+	}
+	return 1 ;
+}
+
+static void OWRomIdxBloomBuild(void) {
+	memset(BloomBits, 0, sizeof(BloomBits)) ;
+	for (size_t i = 0; i < RomCount; ++i) {
+		OWRomIdxBloomSet(RomIdx[i]) ;
+	}
+}
+#endif
+
+/**
+ * OWRomIdxSearch() - binary search for Value
+ * @return	index of the matching entry if found else -(insertion point) - 1
+ */
+static int32_t OWRomIdxSearch(uint64_t Value) {
+	int32_t	Lo = 0, Hi = (int32_t) RomCount - 1 ;
+	while (Lo <= Hi) {
+		int32_t	Mid = (Lo + Hi) >> 1 ;
+		if (RomIdx[Mid] < Value) {
+			Lo = Mid + 1 ;
+		} else if (RomIdx[Mid] > Value) {
+			Hi = Mid - 1 ;
+		} else {
+			return Mid ;
+		}
+	}
+	return -Lo - 1 ;
+}
+
+static int OWRomIdxCompare(const void * pA, const void * pB) {
+	uint64_t A = *(const uint64_t *) pA, B = *(const uint64_t *) pB ;
+	return (A > B) - (A < B) ;
+}
+
+/**
+ * OWRomIdxLock() - take the index mutex, created on first use
+ * @brief	The index is independent of bridge (re)identification, a whitelist can be loaded
+ * 			before the bridge is found. Should 2 tasks race on first use the loser's mutex is freed.
+ * @param	Wait		ticks to wait, portMAX_DELAY for maintenance, bounded in the read path
+ * @return	erSUCCESS if taken, erFAILURE if timed out
+ */
+static int32_t OWRomIdxLock(TickType_t Wait) {
+	if (__atomic_load_n(&RomMux, __ATOMIC_ACQUIRE) == 0) {
+		SemaphoreHandle_t	Mux = xSemaphoreCreateMutex() ;
+		SemaphoreHandle_t	Null = 0 ;
+		IF_myASSERT(debugRESULT, Mux != 0) ;
+		if (__atomic_compare_exchange_n(&RomMux, &Null, Mux, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == 0) {
+			vSemaphoreDelete(Mux) ;
+		}
+	}
+	return xRtosSemaphoreTake(&RomMux, Wait) == pdTRUE ? erSUCCESS : erFAILURE ;
+}
+
+/**
+ * OWRomIdxLookup() - Bloom filter then binary search, index mutex MUST be held
+ * @return	1 if found else 0
+ */
+static int32_t OWRomIdxLookup(uint64_t Value) {
+#if		(owROMIDX_BLOOM == 1)
+	if (OWRomIdxBloomTest(Value) == 0) {
+		return 0 ;
+	}
+#endif
+	return OWRomIdxSearch(Value) >= 0 ? 1 : 0 ;
+}
+
+// ################################# Application support functions #################################
+
+/**
+ * OWRomIdxInit() - empty the index, all ROM's read are then reported as owACCESS_NONE
+ */
+void	OWRomIdxInit(void) {
+	OWRomIdxLock(portMAX_DELAY) ;
+	RomCount = 0 ;
+#if		(owROMIDX_BLOOM == 1)
+	memset(BloomBits, 0, sizeof(BloomBits)) ;
+#endif
+	xRtosSemaphoreGive(&RomMux) ;
+}
+
+/**
+ * OWRomIdxLoad() - replace the complete index, typically at startup
+ * @param	pValues		array of ow_rom_t.Value's, any order, duplicates allowed
+ * @param	Count		number of entries
+ * @return	number of (unique) entries loaded or erFAILURE if too many
+ */
+int32_t	OWRomIdxLoad(const uint64_t * pValues, size_t Count) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(pValues) || Count == 0) ;
+	if (Count > owROMIDX_MAX) {
+		SL_ERR("ROM index overflow %d > %d", (int) Count, owROMIDX_MAX) ;
+		return erFAILURE ;
+	}
+	OWRomIdxLock(portMAX_DELAY) ;
+	memcpy(RomIdx, pValues, Count * sizeof(uint64_t)) ;
+	qsort(RomIdx, Count, sizeof(uint64_t), OWRomIdxCompare) ;
+	size_t	Unique = 0 ;
+	for (size_t i = 0; i < Count; ++i) {				// remove duplicates
+		if (Unique == 0 || RomIdx[Unique - 1] != RomIdx[i]) {
+			RomIdx[Unique++] = RomIdx[i] ;
+		}
+	}
+	RomCount = Unique ;
+#if		(owROMIDX_BLOOM == 1)
+	OWRomIdxBloomBuild() ;
+#endif
+	xRtosSemaphoreGive(&RomMux) ;
+	IF_PRINT(debugTRACK, "ROM index loaded %d/%d\n", (int) Unique, (int) Count) ;
+	return Unique ;
+}
+
+/**
+ * OWRomIdxAdd() - insert a single ROM in sorted position
+ * @return	erSUCCESS if added or already present, erFAILURE if index full
+ */
+int32_t	OWRomIdxAdd(uint64_t Value) {
+	int32_t	iRV = erSUCCESS ;
+	OWRomIdxLock(portMAX_DELAY) ;
+	int32_t	Idx = OWRomIdxSearch(Value) ;
+	if (Idx < 0) {
+		if (RomCount < owROMIDX_MAX) {
+			Idx = -Idx - 1 ;
+			memmove(&RomIdx[Idx + 1], &RomIdx[Idx], (RomCount - Idx) * sizeof(uint64_t)) ;
+			RomIdx[Idx] = Value ;
+			++RomCount ;
+#if		(owROMIDX_BLOOM == 1)
+			OWRomIdxBloomSet(Value) ;
+#endif
+		} else {
+			iRV = erFAILURE ;
+		}
+	}
+	xRtosSemaphoreGive(&RomMux) ;
+	return iRV ;
+}
+
+/**
+ * OWRomIdxRemove() - remove a single ROM
+ * @return	erSUCCESS if removed, erFAILURE if not found
+ */
+int32_t	OWRomIdxRemove(uint64_t Value) {
+	int32_t	iRV = erFAILURE ;
+	OWRomIdxLock(portMAX_DELAY) ;
+	int32_t	Idx = OWRomIdxSearch(Value) ;
+	if (Idx >= 0) {
+		--RomCount ;
+		memmove(&RomIdx[Idx], &RomIdx[Idx + 1], (RomCount - Idx) * sizeof(uint64_t)) ;
+#if		(owROMIDX_BLOOM == 1)
+		OWRomIdxBloomBuild() ;							// bits can not be cleared individually
+#endif
+		iRV = erSUCCESS ;
+	}
+	xRtosSemaphoreGive(&RomMux) ;
+	return iRV ;
+}
+
+/**
+ * OWRomIdxFind() - check if a ROM is enrolled
+ * @return	1 if found else 0
+ */
+int32_t	OWRomIdxFind(uint64_t Value) {
+	OWRomIdxLock(portMAX_DELAY) ;
+	int32_t	iRV = OWRomIdxLookup(Value) ;
+	xRtosSemaphoreGive(&RomMux) ;
+	return iRV ;
+}
+
+/**
+ * OWRomIdxAccess() - access decision for a ROM just read
+ * @brief	Called from the scan, so never waits behind a Load() (qsort) for longer than
+ * 			owROMIDX_WAIT_MS (at least 1 tick), no decision is made if the index is busy.
+ * @return	owACCESS_NONE if no whitelist loaded or index busy, else owACCESS_GRANT or owACCESS_DENY
+ */
+int32_t	OWRomIdxAccess(ow_rom_t ROM) {
+	TickType_t	Wait = pdMS_TO_TICKS(owROMIDX_WAIT_MS) ;
+	if (OWRomIdxLock(Wait ? Wait : 1) != erSUCCESS) {
+		IF_PRINT(debugTRACK, "ROM index busy, no decision\n") ;
+		return owACCESS_NONE ;
+	}
+	int32_t	iRV = owACCESS_NONE ;
+	if (RomCount) {
+		iRV = OWRomIdxLookup(ROM.Value) ? owACCESS_GRANT : owACCESS_DENY ;
+	}
+	xRtosSemaphoreGive(&RomMux) ;
+	return iRV ;
+}
+
+size_t	OWRomIdxCount(void) { return __atomic_load_n(&RomCount, __ATOMIC_RELAXED) ; }
+
+#endif
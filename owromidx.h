@@ -0,0 +1,56 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owromidx.h
+ */
+
+#pragma		once
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+#include	<stddef.h>
+
+// ############################################# Macros ############################################
+
+#define	owROMIDX_MAX						2048		// Maximum number of enrolled ROM's
+#define	owROMIDX_BLOOM						1			// 0=binary search only, 1=Bloom filter in front
+#define	owROMIDX_BLOOM_BITS					16384		// MUST be a power of 2, ~8 bits per key
+#define	owROMIDX_BLOOM_HASHES				3
+#define	owROMIDX_WAIT_MS					5			// max wait in the read path, else owACCESS_NONE
+
+// ######################################## Enumerations ###########################################
+
+enum {													// result of an access decision
+	owACCESS_NONE,										// no whitelist loaded, no decision made
+	owACCESS_GRANT,
+	owACCESS_DENY,
+} ;
+
+// ###################################### Private functions ########################################
+
+void	OWRomIdxInit(void) ;
+int32_t	OWRomIdxLoad(const uint64_t * pValues, size_t Count) ;
+int32_t	OWRomIdxAdd(uint64_t Value) ;
+int32_t	OWRomIdxRemove(uint64_t Value) ;
+int32_t	OWRomIdxFind(uint64_t Value) ;
+int32_t	OWRomIdxAccess(ow_rom_t ROM) ;
+size_t	OWRomIdxCount(void) ;
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owxact.c - 1-Wire transaction descriptor engine
+ */
+
+#include	"x_config.h"
+
+#if		(halHAS_DS2482_100 == 1 || halHAS_DS2482_800 == 1 || halHAS_DS2484 == 1)
+
+#include	"owxact.h"
+#include	"ds2482.h"
+#include	"ds2409.h"
+
+#include	"syslog.h"
+#include	"printfx.h"
+#include	"x_errors_events.h"
+
+#include	"hal_debug.h"
+
+#define	debugFLAG					0xC000
+
+#define	debugTRACK					(debugFLAG & 0x2000)
+#define	debugPARAM					(debugFLAG & 0x4000)
+#define	debugRESULT					(debugFLAG & 0x8000)
+
+/* Family drivers describe WHAT must happen on the bus, the engine decides HOW. All bytes go
+ * through the fused bridge primitives so a transaction never returns to the scheduler between
+ * bytes, and the shadow state (ds2482.c) elides CHSL/WCFG/SRP that would not change anything.
+ * Compared to the legacy OWWriteByteWait()/OWReadByte() path each byte written saves one and
+ * each byte read saves two I2C transactions, excluding busy polls. */
+
+// ####################################### Local functions #########################################
+
+static int32_t	OWXactWrite(uint8_t Byte, int32_t Power) {
+	if (Power) {
+		sDS2482.Regs.SPU = 1 ;							// arm strong pullup for this byte
+		if (ds2482WriteConfig() != 1) {
+			return erFAILURE ;
+		}
+	}
+	return ds2482XactWriteByte(Byte) ;
+}
+
+static int32_t	OWXactExec(const ow_xact_t * psXact) {
+	int32_t	iRV ;
+	if ((psXact->Flags & owXACT_RESET) && ds2482OWReset() == 0) {
+		return 0 ;										// nobody there, or shorted
+	}
+
+	// count the bytes to write so the strong pullup can be armed for the last one only
+	int32_t	Left = psXact->TxLen + (psXact->Cmd ? 1 : 0) ;
+	int32_t	Power = (psXact->Flags & owXACT_POWER) ? 1 : 0 ;
+	if (psXact->Flags & owXACT_MATCH) {
+		IF_myASSERT(debugPARAM, INRANGE_SRAM(psXact->psROM)) ;
+		iRV = OWXactWrite(OW_CMD_MATCHROM, 0) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+		for (int32_t i = 0; i < ONEWIRE_ROM_LENGTH; ++i) {
+			iRV = OWXactWrite(psXact->psROM->HexChars[i], Power && Left == 0 && i == (ONEWIRE_ROM_LENGTH - 1)) ;
+			LT_RETURN(iRV, erSUCCESS) ;
+		}
+	} else if (psXact->Flags & owXACT_SKIP) {
+		iRV = OWXactWrite(OW_CMD_SKIPROM, Power && Left == 0) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+	}
+	if (psXact->Cmd) {
+		iRV = OWXactWrite(psXact->Cmd, Power && --Left == 0) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+	}
+	for (int32_t i = 0; i < psXact->TxLen; ++i) {
+		iRV = OWXactWrite(psXact->pTx[i], Power && --Left == 0) ;
+		LT_RETURN(iRV, erSUCCESS) ;
+	}
+
+	for (int32_t i = 0; i < psXact->RxLen; ++i) {
+		iRV = ds2482XactReadByte() ;
+		LT_RETURN(iRV, erSUCCESS) ;
+		psXact->pRx[i] = iRV ;
+	}
+	if (psXact->Flags & owXACT_CRC8) {
+		return OWCheckCRC(psXact->pRx, psXact->RxLen) ;
+	}
+	return 1 ;
+}
+
+// ####################################### Public functions ########################################
+
+/**
+ * OWXactRun() - execute a transaction descriptor
+ * @brief	The bridge is locked (and the channel selected) for the whole transaction
+ * @param	psXact	descriptor, see owxact.h for the sequence
+ * @return	1 if completed (and CRC correct if requested)
+ * 			0 if no presence pulse or CRC error
+ * 			erFAILURE if the bridge failed
+ */
+int32_t	OWXactRun(const ow_xact_t * psXact) {
+	IF_myASSERT(debugPARAM, INRANGE_SRAM(psXact)) ;
+	IF_myASSERT(debugPARAM, (psXact->Flags & (owXACT_MATCH | owXACT_SKIP)) != (owXACT_MATCH | owXACT_SKIP)) ;
+	IF_myASSERT(debugPARAM, (psXact->Flags & owXACT_POWER) == 0 || psXact->RxLen == 0) ;
+	uint8_t	Chan = (psXact->Flags & owXACT_CHAN) ? psXact->Chan : sDS2482.CurChan ;
+	int32_t	iRV = ds2482Lock(Chan) ;
+	NE_RETURN(iRV, erSUCCESS) ;
+#if		(halHAS_DS2409 == 1)
+	if ((psXact->Flags & owXACT_MATCH) && ds2409Select(Chan, ds2409Route(*psXact->psROM)) != erSUCCESS) {
+		ds2482Unlock() ;								// device behind a coupler, branch not on
+		return erFAILURE ;
+	}
+#endif
+	iRV = OWXactExec(psXact) ;
+	for (int32_t Try = 0; iRV == erFAILURE && Try < owXACT_RESUME && (psXact->Flags & owXACT_RESET); ++Try) {
+		if (ds2482Recover() != erSUCCESS) {				// glitch: restore the bridge and
+			break ;
+		}
+		iRV = OWXactExec(psXact) ;						// restart from the 1-Wire reset
+	}
+	ds2482Unlock() ;
+	return iRV ;
+}
+
+#endif
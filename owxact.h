@@ -0,0 +1,60 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * owxact.h - declarative 1-Wire transaction descriptors
+ */
+
+#pragma		once
+
+#include	"onewire.h"
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+// Transaction flags, steps are executed in the order listed
+#define	owXACT_CHAN							0x01		// select Chan first (DS2482-800 only)
+#define	owXACT_RESET						0x02		// 1-Wire reset, stop if no presence
+#define	owXACT_MATCH						0x04		// Match ROM using psROM
+#define	owXACT_SKIP							0x08		// Skip ROM, address all devices
+#define	owXACT_POWER						0x10		// strong pullup after the last byte written
+#define	owXACT_CRC8							0x20		// check CRC8 over the bytes read
+
+#define	owXACT_RESUME						1			// restarts after a bridge recovery, needs owXACT_RESET
+
+// ######################################### Structures ############################################
+
+/* One complete 1-Wire exchange: [CHSL] [reset] [MATCH+ROM | SKIP] [Cmd] [Tx...] [Rx...] [CRC]
+ * Cmd == 0 means no function command, the bytes in pTx (if any) follow the addressing. */
+typedef struct ow_xact_t {
+	ow_rom_t *	psROM ;									// device to MATCH, aligned (copy a packed member first)
+	uint8_t *	pTx ;									// data written after Cmd
+	uint8_t *	pRx ;									// buffer for data read
+	uint8_t		Flags ;									// owXACT_????
+	uint8_t		Chan ;									// logical channel for owXACT_CHAN
+	uint8_t		Cmd ;									// function command, 0 = none
+	uint8_t		TxLen ;
+	uint8_t		RxLen ;
+} ow_xact_t ;
+
+// ###################################### Private functions ########################################
+
+int32_t	OWXactRun(const ow_xact_t * psXact) ;
@@ -0,0 +1,383 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2480bpty.c - host test of the DS2480B backend against a pseudo terminal stand-in
+ *
+ * Build:	cc -O2 -pthread -Itools/host -o ds2480bpty tools/ds2480bpty.c ds2480b.c owbus.c tools/host/hostrtos.c
+ * Usage:	ds2480bpty [seed]
+ *
+ * A thread on the master side of a pseudo terminal models a DS2480B (command & data mode, the
+ * 0xE3 escape, reset, single bit, configuration and the search accelerator) with a population
+ * of simulated devices on its 1-Wire side. The driver opens the slave side as if it was a serial
+ * port and the generic 1-Wire API (owbus.h) is exercised through it: presence, search with and
+ * without a family target, addressed scratchpad reads via OWWriteByte/OWReadByte and OWBlock.
+ * Exits with 0 if all checks passed.
+ */
+
+#define	_GNU_SOURCE										// posix_openpt() & friends
+
+#include	"../ds2480b.h"
+
+#include	<fcntl.h>
+#include	<pthread.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<unistd.h>
+
+// ############################################# Macros ############################################
+
+#define	simMAX_DEV							128
+#define	simSP_LEN							9
+
+#define	CHECK(x)	do { ++Checks ; if (!(x)) { ++Fails ; printf("FAIL %s:%d %s\n", __FUNCTION__, __LINE__, #x) ; } } while (0)
+
+// ######################################## Enumerations ###########################################
+
+enum { OW_IDLE, OW_ROMCMD, OW_MATCH, OW_READROM, OW_FUNC, OW_READSP } ;
+
+// ######################################### Local data ############################################
+
+static struct {
+	ow_rom_t	ROM ;
+	uint8_t		SP[simSP_LEN] ;
+	uint8_t		Active ;
+} sDev[simMAX_DEV] ;
+
+static struct {											// model of the DS2480B & 1-Wire side
+	int			fd ;
+	int			Count ;									// devices on the 1-Wire
+	uint8_t		Data ;									// 1 = data mode
+	uint8_t		Escape ;								// 0xE3 seen in data mode
+	uint8_t		Accel ;									// search accelerator on
+	uint8_t		Timed ;									// timing byte received
+	uint8_t		State ;
+	uint8_t		Index ;
+	uint8_t		Param[8] ;
+	uint8_t		Srch[16] ;
+	uint8_t		SrchLen ;
+} sSim ;
+
+static pthread_mutex_t	SimLock = PTHREAD_MUTEX_INITIALIZER ;
+static int		Checks, Fails ;
+
+// ################################## Simulated 1-Wire devices #####################################
+
+static uint8_t	SimCrc8(const uint8_t * pBuf, size_t Len) {
+	uint8_t	crc8 = 0 ;
+	while (Len--) {
+		crc8 ^= *pBuf++ ;
+		for (int i = 0; i < 8; ++i) {
+			crc8 = (crc8 & 1) ? (crc8 >> 1) ^ 0x8C : (crc8 >> 1) ;
+		}
+	}
+	return crc8 ;
+}
+
+static void	SimPopulate(int Count) {
+	static const uint8_t Family[] = { 0x10, 0x28, 0x3A, 0x29 } ;
+	pthread_mutex_lock(&SimLock) ;
+	for (int Idx = 0; Idx < Count; ++Idx) {
+		int		Dup ;
+		do {
+			sDev[Idx].ROM.Family = Family[rand() % sizeof(Family)] ;
+			for (int i = 0; i < 6; ++i) {
+				sDev[Idx].ROM.TagNum[i] = rand() ;
+			}
+			if (Idx == 0) {
+				sDev[Idx].ROM.TagNum[2] = ds2480bMODE_COMMAND ;	// must be escaped when written
+			}
+			sDev[Idx].ROM.CRC = SimCrc8(sDev[Idx].ROM.HexChars, 7) ;
+			Dup = 0 ;
+			for (int j = 0; j < Idx; ++j) {
+				Dup |= (sDev[j].ROM.Value == sDev[Idx].ROM.Value) ;
+			}
+		} while (Dup) ;
+		for (int i = 0; i < simSP_LEN - 1; ++i) {
+			sDev[Idx].SP[i] = (i == 3) ? ds2480bMODE_COMMAND : rand() ;
+		}
+		sDev[Idx].SP[simSP_LEN - 1] = SimCrc8(sDev[Idx].SP, simSP_LEN - 1) ;
+	}
+	sSim.Count = Count ;
+	pthread_mutex_unlock(&SimLock) ;
+}
+
+static uint8_t	SimWired(int Which) {						// wired AND of the active devices
+	uint8_t	Byte = 0xFF ;
+	for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+		if (sDev[Idx].Active) {
+			Byte &= (Which < 0) ? sDev[Idx].SP[-Which - 1] : sDev[Idx].ROM.HexChars[Which] ;
+		}
+	}
+	return Byte ;
+}
+
+static uint8_t	SimTouchByte(uint8_t Byte) {
+	switch (sSim.State) {
+	case OW_ROMCMD:
+		sSim.Index = 0 ;
+		sSim.State = (Byte == OW_CMD_MATCHROM) ? OW_MATCH : (Byte == OW_CMD_READROM) ? OW_READROM
+					: (Byte == OW_CMD_SKIPROM) ? OW_FUNC : OW_IDLE ;
+		return Byte ;
+	case OW_MATCH:
+		for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+			sDev[Idx].Active &= (sDev[Idx].ROM.HexChars[sSim.Index] == Byte) ;
+		}
+		if (++sSim.Index == ONEWIRE_ROM_LENGTH) {
+			sSim.State = OW_FUNC ;
+		}
+		return Byte ;
+	case OW_READROM:
+		Byte &= SimWired(sSim.Index) ;
+		if (++sSim.Index == ONEWIRE_ROM_LENGTH) {
+			sSim.State = OW_IDLE ;
+		}
+		return Byte ;
+	case OW_FUNC:
+		sSim.Index = 0 ;
+		sSim.State = (Byte == 0xBE) ? OW_READSP : OW_IDLE ;
+		return Byte ;
+	case OW_READSP:
+		if (sSim.Index < simSP_LEN) {
+			Byte &= SimWired(-(++sSim.Index)) ;
+		}
+		return Byte ;
+	default:
+		return Byte ;
+	}
+}
+
+/* 16 bytes in, bit 2n+1 is the direction to take at ROM bit n on a discrepancy. 16 bytes out,
+ * bit 2n flags a discrepancy and bit 2n+1 is the direction taken */
+static void	SimSearch(uint8_t * pBuf) {
+	uint8_t	cOut[16] = { 0 } ;
+	for (int Bit = 0; Bit < 64; ++Bit) {
+		int	Has0 = 0, Has1 = 0 ;
+		for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+			if (sDev[Idx].Active) {
+				if ((sDev[Idx].ROM.HexChars[Bit / 8] >> (Bit % 8)) & 1) {
+					Has1 = 1 ;
+				} else {
+					Has0 = 1 ;
+				}
+			}
+		}
+		int	Want = (pBuf[(Bit * 2 + 1) / 8] >> ((Bit * 2 + 1) % 8)) & 1 ;
+		int	Flag = (Has0 == Has1) ;
+		int	Dir = (Has0 && Has1) ? Want : Has1 ? 1 : Has0 ? 0 : 1 ;
+		cOut[(Bit * 2) / 8]		|= Flag << ((Bit * 2) % 8) ;
+		cOut[(Bit * 2 + 1) / 8]	|= Dir << ((Bit * 2 + 1) % 8) ;
+		for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+			sDev[Idx].Active &= (((sDev[Idx].ROM.HexChars[Bit / 8] >> (Bit % 8)) & 1) == Dir) ;
+		}
+	}
+	memcpy(pBuf, cOut, sizeof(cOut)) ;
+	sSim.State = OW_FUNC ;								// search leaves one device selected
+}
+
+// ###################################### Simulated DS2480B ########################################
+
+static int	SimCommand(uint8_t Cmd, uint8_t * pOut) {
+	if (Cmd == ds2480bMODE_DATA) {
+		sSim.Data = 1 ;
+		return 0 ;
+	}
+	if (Cmd == ds2480bMODE_COMMAND) {
+		return 0 ;
+	}
+	if ((Cmd & 0xE3) == 0xC1) {							// reset, the first one is the timing byte
+		if (sSim.Timed == 0) {
+			sSim.Timed = 1 ;
+			return 0 ;
+		}
+		int	Present = 0 ;
+		for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+			sDev[Idx].Active = 1 ;
+			Present = 1 ;
+		}
+		sSim.State = OW_ROMCMD ;
+		*pOut = 0xCC | (Present ? ds2480bRST_PRESENCE : ds2480bRST_NONE) ;
+		return 1 ;
+	}
+	if ((Cmd & 0xE3) == 0x81) {							// single bit, nobody pulls low
+		*pOut = (Cmd & 0xFC) | ((Cmd & 0x10) ? 0x03 : 0x00) ;
+		return 1 ;
+	}
+	if ((Cmd & 0xE3) == 0xA1) {							// search accelerator on/off
+		sSim.Accel = (Cmd & 0x10) ? 1 : 0 ;
+		sSim.SrchLen = 0 ;
+		return 0 ;
+	}
+	if ((Cmd & 0x81) == 0x01) {							// configuration, 0ppp vvv1
+		int	Code = (Cmd >> 4) & 0x07 ;
+		if (Code == 0) {								// read parameter (Cmd >> 1)
+			*pOut = sSim.Param[(Cmd >> 1) & 0x07] << 1 ;
+		} else {
+			sSim.Param[Code] = (Cmd >> 1) & 0x07 ;
+			*pOut = Cmd & 0xFE ;
+		}
+		return 1 ;
+	}
+	return 0 ;
+}
+
+static int	SimByte(uint8_t Byte, uint8_t * pOut) {
+	if (sSim.Data == 0) {
+		return SimCommand(Byte, pOut) ;
+	}
+	if (sSim.Escape) {
+		sSim.Escape = 0 ;
+		if (Byte != ds2480bMODE_COMMAND) {				// not doubled, a mode switch
+			sSim.Data = 0 ;
+			return SimCommand(Byte, pOut) ;
+		}
+	} else if (Byte == ds2480bMODE_COMMAND) {
+		sSim.Escape = 1 ;
+		return 0 ;
+	}
+	if (sSim.Accel) {
+		sSim.Srch[sSim.SrchLen++] = Byte ;
+		if (sSim.SrchLen < sizeof(sSim.Srch)) {
+			return 0 ;
+		}
+		sSim.SrchLen = 0 ;
+		SimSearch(sSim.Srch) ;
+		memcpy(pOut, sSim.Srch, sizeof(sSim.Srch)) ;
+		return sizeof(sSim.Srch) ;
+	}
+	*pOut = SimTouchByte(Byte) ;
+	return 1 ;
+}
+
+static void * SimTask(void * pVoid) {
+	(void) pVoid ;
+	uint8_t	cIn[256], cOut[256 + 16] ;
+	for (;;) {
+		ssize_t	Len = read(sSim.fd, cIn, sizeof(cIn)) ;
+		if (Len <= 0) {
+			break ;
+		}
+		int	Out = 0 ;
+		pthread_mutex_lock(&SimLock) ;
+		for (ssize_t i = 0; i < Len; ++i) {
+			Out += SimByte(cIn[i], &cOut[Out]) ;
+		}
+		pthread_mutex_unlock(&SimLock) ;
+		if (Out && write(sSim.fd, cOut, Out) != Out) {
+			break ;
+		}
+	}
+	return NULL ;
+}
+
+// ########################################### Tests ###############################################
+
+static int	SimFind(uint64_t Value) {
+	for (int Idx = 0; Idx < sSim.Count; ++Idx) {
+		if (sDev[Idx].ROM.Value == Value) {
+			return Idx ;
+		}
+	}
+	return -1 ;
+}
+
+static void	TestSearch(int Count) {
+	uint8_t	Seen[simMAX_DEV] = { 0 } ;
+	int		Found = 0, iRV ;
+	ow_search_t	sS ;
+	OWSearchInit(&sS, 0, 0) ;
+	while ((iRV = OWSearchNext(&sS)) == 1) {
+		int	Idx = SimFind(sS.ROM.Value) ;
+		CHECK(Idx >= 0 && Seen[Idx] == 0) ;
+		if (Idx >= 0) {
+			Seen[Idx] = 1 ;
+		}
+		if (++Found > Count) {
+			break ;
+		}
+	}
+	CHECK(iRV == 0) ;
+	CHECK(Found == Count) ;
+
+	for (int Idx = 0; Idx < Count; ++Idx) {				// family targeted, first one found
+		uint8_t	Family = sDev[Idx].ROM.Family ;
+		OWSearchInit(&sS, 0, Family) ;
+		CHECK(OWSearchNext(&sS) == 1 && sS.ROM.Family == Family) ;
+	}
+}
+
+static void	TestAddressed(int Count) {
+	for (int Idx = 0; Idx < Count && Idx < 8; ++Idx) {
+		uint8_t	cBuf[1 + ONEWIRE_ROM_LENGTH + 1 + simSP_LEN] ;
+		CHECK(OWBusLock(0) == erSUCCESS) ;
+		CHECK(OWReset() == 1) ;							// byte by byte
+		CHECK(OWWriteByte(OW_CMD_MATCHROM) == erSUCCESS) ;
+		for (int i = 0; i < ONEWIRE_ROM_LENGTH; ++i) {
+			CHECK(OWWriteByte(sDev[Idx].ROM.HexChars[i]) == erSUCCESS) ;
+		}
+		CHECK(OWWriteByte(0xBE) == erSUCCESS) ;
+		for (int i = 0; i < simSP_LEN; ++i) {
+			CHECK(OWReadByte() == sDev[Idx].SP[i]) ;
+		}
+
+		CHECK(OWReset() == 1) ;							// as a single block
+		cBuf[0] = OW_CMD_MATCHROM ;
+		memcpy(&cBuf[1], sDev[Idx].ROM.HexChars, ONEWIRE_ROM_LENGTH) ;
+		cBuf[1 + ONEWIRE_ROM_LENGTH] = 0xBE ;
+		memset(&cBuf[2 + ONEWIRE_ROM_LENGTH], 0xFF, simSP_LEN) ;
+		OWBlock(cBuf, sizeof(cBuf)) ;
+		CHECK(memcmp(&cBuf[1], sDev[Idx].ROM.HexChars, ONEWIRE_ROM_LENGTH) == 0) ;
+		CHECK(memcmp(&cBuf[2 + ONEWIRE_ROM_LENGTH], sDev[Idx].SP, simSP_LEN) == 0) ;
+		CHECK(SimCrc8(&cBuf[2 + ONEWIRE_ROM_LENGTH], simSP_LEN) == 0) ;
+		OWBusUnlock() ;
+	}
+}
+
+int		main(int argc, char * argv[]) {
+	srand((argc > 1) ? atoi(argv[1]) : 1) ;
+	sSim.fd = posix_openpt(O_RDWR | O_NOCTTY) ;
+	if (sSim.fd < 0 || grantpt(sSim.fd) != 0 || unlockpt(sSim.fd) != 0) {
+		perror("posix_openpt") ;
+		return 2 ;
+	}
+	pthread_t	Task ;
+	pthread_create(&Task, NULL, SimTask, NULL) ;
+	if (ds2480bIdentify(0, ptsname(sSim.fd)) != erSUCCESS) {
+		printf("FAIL DS2480B not identified on %s\n", ptsname(sSim.fd)) ;
+		return 1 ;
+	}
+	CHECK(psOWBus == &ds2480bBus) ;
+	CHECK(OWTouchBit(1) == 1 && OWTouchBit(0) == 0) ;
+
+	static const int Population[] = { 0, 1, 2, 5, 17, 64, simMAX_DEV } ;
+	for (size_t i = 0; i < sizeof(Population) / sizeof(Population[0]); ++i) {
+		int	Count = Population[i] ;
+		SimPopulate(Count) ;
+		OWBusLock(0) ;
+		CHECK(OWReset() == (Count ? 1 : 0)) ;
+		OWBusUnlock() ;
+		TestSearch(Count) ;
+		TestAddressed(Count) ;
+		printf("%3d devices: %d checks, %d failed\n", Count, Checks, Fails) ;
+	}
+	printf("%s\n", Fails ? "FAILED" : "PASSED") ;
+	return Fails ? 1 : 0 ;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482scan.c - list the 1-Wire devices behind a DS2482 on a Linux I2C bus
+ *
+ * Build:	cc -O2 -pthread -Itools/host -DhalHAS_DS2480B=0 -o ds2482scan tools/ds2482scan.c ds2482.c
+ *			ds2482stats.c ds2482trace.c ds2482health.c ds2482arb.c owxact.c owbus.c owfamily.c owpolicy.c
+ *			owevents.c owromidx.c hal_i2c_linux.c tools/host/hostrtos.c
+ * Usage:	ds2482scan [i2c bus (N in /dev/i2c-N) [address (0x18..0x1B)]]
+ *
+ * The driver runs in user space with halI2C_????() from hal_i2c_linux.c, the bridge is identified
+ * and every channel searched, one line per device found goes to stdout: channel & ROM as
+ * family/serial/CRC. Exits with 0 if the bridge answered and all channels were searched, 1 if
+ * not (no /dev/i2c-N, adapter without combined transfers, nothing at the address).
+ */
+
+#include	"x_config.h"
+
+#include	"../ds2482.h"
+
+#include	<stdio.h>
+#include	<stdlib.h>
+
+// ########################################### Handler #############################################
+
+static int32_t	ScanHandler(int32_t iCount, void * pVoid) {
+	(void) pVoid ;
+	ow_rom_t sROM = sDS2482.ROM ;						// copy, a member of a packed structure
+	printf("#%d Ch%d %02X/%02X%02X%02X%02X%02X%02X/%02X\n", iCount, sDS2482.CurChan, sROM.Family,
+			sROM.TagNum[0], sROM.TagNum[1], sROM.TagNum[2], sROM.TagNum[3], sROM.TagNum[4],
+			sROM.TagNum[5], sROM.CRC) ;
+	return erSUCCESS ;
+}
+
+// ############################################ Main ###############################################
+
+int		main(int argc, char * argv[]) {
+	int32_t	Bus		= (argc > 1) ? atoi(argv[1]) : 1 ;
+	int32_t	Addr	= (argc > 2) ? (int32_t) strtol(argv[2], NULL, 0) : ds2482ADDR_0 ;
+	if (Bus < 0 || Bus >= halI2C_NUM || Addr < ds2482ADDR_0 || Addr > ds2482ADDR_0 + 3) {
+		fprintf(stderr, "Usage: %s [i2c bus (0..%d) [address (0x%02X..0x%02X)]]\n", argv[0],
+				halI2C_NUM - 1, ds2482ADDR_0, ds2482ADDR_0 + 3) ;
+		return 2 ;
+	}
+	if (ds2482Identify(Bus, Addr) != erSUCCESS) {
+		fprintf(stderr, "no DS2482 at 0x%02X on /dev/i2c-%d\n", Addr, Bus) ;
+		return 1 ;
+	}
+	int32_t	iRV = ds2482ScanAllChannels(0, ScanHandler, NULL) ;
+	if (iRV < erSUCCESS) {
+		fprintf(stderr, "search failed\n") ;
+		return 1 ;
+	}
+	fprintf(stderr, "%d devices\n", iRV) ;
+	return 0 ;
+}
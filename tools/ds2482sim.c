@@ -0,0 +1,475 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482sim.c - host benchmark of the DS2482 driver against a simulated bridge & sensor population
+ *
+ * Build:	cc -O2 -pthread -Itools/host -DhalHAS_DS18X20=1 -DhalHAS_DS2480B=0 -o ds2482sim tools/ds2482sim.c
+ *			ds2482.c ds2482stats.c ds2482trace.c ds2482health.c ds2482arb.c ds2482bench.c owxact.c owbus.c
+ *			owfamily.c owpolicy.c owevents.c owromidx.c ds18x20.c ds28ea00.c tools/host/hostrtos.c
+ * Usage:	ds2482sim [iterations [max devices [channels]]]
+ *
+ * halI2C_????() are implemented here by a DS2482-800 model (registers, read pointer, channel
+ * select, reset, byte, bit & triplet commands) with a population of simulated devices behind
+ * each channel: DS18B20's, a DS18S20 every 8th and an iButton every 16th, all externally
+ * powered and answering search, match/skip/read ROM, convert, scratchpad & power supply reads.
+ * The population is swept from 1 to max devices (200) on each of the first channels (1) and
+ * for each the driver is configured as on target (ds2482Config) and ds2482Benchmark() run, the
+ * output is a JSON array with one object per population.
+ *
+ * 1-Wire commands complete immediately and vTaskDelay() runs in virtual time, so usec and
+ * cpu_usec are the host cost of the driver alone, bus_usec the 1-Wire time it would take and
+ * end_usec that plus the (virtual) conversion & poll waits, the time a sweep takes on target.
+ * Exits with 0 if every population was enumerated and read back correctly.
+ */
+
+#include	"x_config.h"
+
+#include	"../ds2482.h"
+#include	"../ds2482bench.h"
+#include	"../ds18x20.h"
+#include	"../owfamily.h"
+
+#include	"endpoints.h"
+#include	"hal_i2c.h"
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+
+// ############################################# Macros ############################################
+
+#define	simMAX_DEV							200
+#define	simSP_LEN							9
+
+// ######################################## Enumerations ###########################################
+
+enum { OW_IDLE, OW_ROMCMD, OW_MATCH, OW_SEARCH, OW_READROM, OW_FUNC, OW_READSP, OW_WRITESP, OW_CONVERT, OW_PSU } ;
+
+// ######################################### Structures ############################################
+
+typedef struct {
+	ow_rom_t	ROM ;
+	uint8_t		SP[simSP_LEN] ;
+	int16_t		Temp ;									// 1/16 degree
+	uint8_t		Seen ;
+} sim_dev_t ;
+
+typedef struct {
+	sim_dev_t *	psDev ;
+	sim_dev_t **ppSel ;									// devices still selected since the reset
+	int32_t		Count ;
+	int32_t		SelCount ;
+	int32_t		State ;
+	int32_t		Index ;									// byte or bit position in the current state
+	TickType_t	ConvEnd ;								// read slots return 0 till then
+} sim_chan_t ;
+
+// ######################################### Local data ############################################
+
+static const uint8_t	SimChanCode[ds2482NUM_CHAN] = { 0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87 } ;
+static const uint8_t	SimChanRead[ds2482NUM_CHAN] = { 0xB8, 0xB1, 0xAA, 0xA3, 0x9C, 0x95, 0x8E, 0x87 } ;
+
+static struct {
+	uint8_t		Stat, Data, Conf, Chan, Pntr ;
+} sSim ;
+
+static sim_chan_t	sSimChan[ds2482NUM_CHAN] ;
+static uint32_t		SimSeed = 1 ;
+static uint32_t		Conversions ;
+static ep_work_t	sSimEpWork ;
+
+// ####################################### Local functions #########################################
+
+static uint32_t	SimRandom(void) { return SimSeed = SimSeed * 1103515245 + 12345 ; }
+
+static uint8_t	SimCrc8(const uint8_t * pBuf, int32_t Len) {
+	uint8_t	Crc = 0 ;
+	while (Len--) {
+		Crc ^= *pBuf++ ;
+		for (int32_t i = 0; i < 8; ++i) {
+			Crc = (Crc & 1) ? (Crc >> 1) ^ 0x8C : (Crc >> 1) ;
+		}
+	}
+	return Crc ;
+}
+
+static void	SimUpdateSP(sim_dev_t * psDev) {
+	if (psDev->ROM.Family == OWFAMILY_10) {				// 0.5 degree resolution
+		int16_t	Half = psDev->Temp / 8 ;
+		psDev->SP[0] = Half & 0xFF ;
+		psDev->SP[1] = (Half >> 8) & 0xFF ;
+	} else {
+		psDev->SP[0] = psDev->Temp & 0xFF ;
+		psDev->SP[1] = (psDev->Temp >> 8) & 0xFF ;
+	}
+	psDev->SP[simSP_LEN - 1] = SimCrc8(psDev->SP, simSP_LEN - 1) ;
+}
+
+static void	SimPopulate(int32_t Count, int32_t Channels) {
+	for (int32_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+		sim_chan_t * psC = &sSimChan[Chan] ;
+		free(psC->psDev) ;
+		free(psC->ppSel) ;
+		psC->Count = (Chan < Channels) ? Count : 0 ;
+		psC->psDev = calloc(psC->Count ? psC->Count : 1, sizeof(sim_dev_t)) ;
+		psC->ppSel = calloc(psC->Count ? psC->Count : 1, sizeof(sim_dev_t *)) ;
+		psC->SelCount = 0 ;
+		psC->State = OW_IDLE ;
+		for (int32_t i = 0; i < psC->Count; ++i) {
+			sim_dev_t * psDev = &psC->psDev[i] ;
+			psDev->ROM.Family = (i % 16 == 15) ? OWFAMILY_01 : (i % 8 == 7) ? OWFAMILY_10 : OWFAMILY_28 ;
+			for (int32_t j = 0; j < 6; ++j) {
+				psDev->ROM.TagNum[j] = SimRandom() >> 16 ;
+			}
+			psDev->ROM.CRC = SimCrc8(psDev->ROM.HexChars, 7) ;
+			uint8_t	SP[simSP_LEN] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x00 } ;
+			memcpy(psDev->SP, SP, sizeof(SP)) ;
+			psDev->Temp = 16 * 20 + 8 * (i % 24) - 16 * 25 * (i % 5 == 4) ;	// some below zero
+			SimUpdateSP(psDev) ;
+		}
+	}
+}
+
+// ################################### Simulated 1-Wire devices ####################################
+
+/* The selected devices are kept as a list that shrinks with every ROM bit or byte that does not
+ * match, so a search pass costs the simulation about 2N steps instead of 64N and the host CPU
+ * time reported is mostly that of the driver. */
+
+static void	SimOWReset(sim_chan_t * psC) {
+	for (int32_t i = 0; i < psC->Count; ++i) {
+		psC->ppSel[i] = &psC->psDev[i] ;
+	}
+	psC->SelCount = psC->Count ;
+	psC->State = OW_ROMCMD ;
+	psC->Index = 0 ;
+}
+
+static void	SimOWDeselect(sim_chan_t * psC, uint32_t Byte, uint8_t Mask, uint8_t Value) {
+	int32_t	Keep = 0 ;
+	for (int32_t i = 0; i < psC->SelCount; ++i) {
+		if ((psC->ppSel[i]->ROM.HexChars[Byte] & Mask) == Value) {
+			psC->ppSel[Keep++] = psC->ppSel[i] ;
+		}
+	}
+	psC->SelCount = Keep ;
+}
+
+static int32_t	SimOWConverting(sim_chan_t * psC) {
+	return psC->State == OW_CONVERT && (int32_t) (xTaskGetTickCount() - psC->ConvEnd) < 0 ;
+}
+
+static uint8_t	SimOWReadByte(sim_chan_t * psC) {
+	if (SimOWConverting(psC)) {
+		return 0x00 ;
+	}
+	uint8_t	Byte = 0xFF ;								// wired AND of all selected devices
+	for (int32_t i = 0; i < psC->SelCount; ++i) {
+		sim_dev_t * psDev = psC->ppSel[i] ;
+		if (psC->State == OW_READSP && psC->Index < simSP_LEN) {
+			Byte &= psDev->SP[psC->Index] ;
+		} else if (psC->State == OW_READROM && psC->Index < ONEWIRE_ROM_LENGTH) {
+			Byte &= psDev->ROM.HexChars[psC->Index] ;
+		}
+	}
+	++psC->Index ;										// CONVERT (done) & PSU (external) read 1's
+	return Byte ;
+}
+
+static void	SimOWWriteByte(sim_chan_t * psC, uint8_t Byte) {
+	switch (psC->State) {
+	case OW_ROMCMD:
+		psC->Index = 0 ;
+		psC->State =	(Byte == OW_CMD_MATCHROM)	? OW_MATCH :
+						(Byte == OW_CMD_SKIPROM)	? OW_FUNC :
+						(Byte == OW_CMD_SEARCHROM)	? OW_SEARCH :
+						(Byte == OW_CMD_READROM)	? OW_READROM : OW_IDLE ;
+		break ;
+
+	case OW_MATCH:
+		SimOWDeselect(psC, psC->Index, 0xFF, Byte) ;
+		if (++psC->Index == ONEWIRE_ROM_LENGTH) {
+			psC->State = OW_FUNC ;
+		}
+		break ;
+
+	case OW_FUNC:
+		psC->Index = 0 ;
+		psC->State =	(Byte == DS18X20_READ_SP)	? OW_READSP :
+						(Byte == DS18X20_WRITE_SP)	? OW_WRITESP :
+						(Byte == DS18X20_CONVERT)	? OW_CONVERT :
+						(Byte == DS18X20_READ_PSU)	? OW_PSU : OW_IDLE ;
+		if (psC->State == OW_CONVERT) {					// tCONV of the slowest device selected
+			uint32_t Ms = 0 ;
+			++Conversions ;
+			for (int32_t i = 0; i < psC->SelCount; ++i) {
+				sim_dev_t * psDev = psC->ppSel[i] ;
+				if (psDev->ROM.Family != OWFAMILY_01) {
+					psDev->Temp += (SimRandom() & 0x100000) ? 8 : -8 ;
+					SimUpdateSP(psDev) ;
+					uint32_t Conv = (psDev->ROM.Family == OWFAMILY_10) ? 750 : (94 << ((psDev->SP[4] >> 5) & 3)) ;
+					Ms = (Conv > Ms) ? Conv : Ms ;
+				}
+			}
+			psC->ConvEnd = xTaskGetTickCount() + pdMS_TO_TICKS(Ms) ;
+		}
+		break ;
+
+	case OW_WRITESP:										// Thi, Tlo [, Conf] to bytes 2..4
+		for (int32_t i = 0; i < psC->SelCount; ++i) {
+			sim_dev_t * psDev = psC->ppSel[i] ;
+			if (psC->Index < (psDev->ROM.Family == OWFAMILY_28 ? 3 : 2)) {
+				psDev->SP[2 + psC->Index] = Byte ;
+				SimUpdateSP(psDev) ;
+			}
+		}
+		++psC->Index ;
+		break ;
+
+	default:
+		break ;
+	}
+}
+
+static uint8_t	SimOWTriplet(sim_chan_t * psC, uint8_t Dir) {
+	if (psC->State != OW_SEARCH || psC->Index >= 64) {
+		return STATUS_SBR | STATUS_TSB | STATUS_DIR ;
+	}
+	int32_t	Has0 = 0, Has1 = 0 ;
+	uint32_t Byte = psC->Index / 8 ;
+	uint8_t	Mask = 1 << (psC->Index % 8) ;
+	for (int32_t i = 0; i < psC->SelCount && (Has0 == 0 || Has1 == 0); ++i) {
+		if (psC->ppSel[i]->ROM.HexChars[Byte] & Mask) {
+			Has1 = 1 ;
+		} else {
+			Has0 = 1 ;
+		}
+	}
+	uint8_t	Id = !Has0, Cmp = !Has1 ;
+	uint8_t	Taken = (Id == Cmp) ? (Id ? 1 : Dir) : Id ;
+	if (Has0 && Has1) {									// discrepancy, the other branch drops out
+		SimOWDeselect(psC, Byte, Mask, Taken ? Mask : 0) ;
+	}
+	++psC->Index ;
+	return (Id ? STATUS_SBR : 0) | (Cmp ? STATUS_TSB : 0) | (Taken ? STATUS_DIR : 0) ;
+}
+
+// ##################################### Simulated DS2482-800 ######################################
+
+static int32_t	SimI2CWrite(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize) {
+	if (psI2Cdev->addrI2C != ds2482ADDR_0 || TxSize == 0) {
+		return erFAILURE ;								// NAK
+	}
+	sim_chan_t * psC = &sSimChan[sSim.Chan] ;
+	uint8_t	Param = (TxSize > 1) ? pTxBuf[1] : 0 ;
+	switch (pTxBuf[0]) {
+	case CMD_DRST:
+		sSim.Stat	= STATUS_RST | STATUS_LL ;
+		sSim.Conf	= 0 ;
+		sSim.Chan	= 0 ;
+		sSim.Pntr	= ds2482REG_STAT ;
+		return erSUCCESS ;
+
+	case CMD_SRP:
+		for (uint8_t Reg = 0; Reg < ds2482REG_NUM; ++Reg) {
+			if (Param == (uint8_t) ((~Reg << 4) | Reg)) {
+				sSim.Pntr = Reg ;
+				return erSUCCESS ;
+			}
+		}
+		return erFAILURE ;
+
+	case CMD_WCFG:
+		if ((Param >> 4) != (~Param & 0x0F)) {
+			return erFAILURE ;
+		}
+		sSim.Conf	= Param & 0x0F ;
+		sSim.Stat	&= ~STATUS_RST ;
+		sSim.Pntr	= ds2482REG_CONF ;
+		return erSUCCESS ;
+
+	case CMD_CHSL:
+		for (uint8_t Chan = 0; Chan < ds2482NUM_CHAN; ++Chan) {
+			if (Param == SimChanCode[Chan]) {
+				sSim.Chan = Chan ;
+				sSim.Pntr = ds2482REG_CHAN ;
+				return erSUCCESS ;
+			}
+		}
+		return erFAILURE ;
+	}
+
+	sSim.Stat	&= ~(STATUS_RST | STATUS_1WB | STATUS_PPD | STATUS_SD | STATUS_SBR | STATUS_TSB | STATUS_DIR) ;
+	sSim.Pntr	= ds2482REG_STAT ;						// 1-Wire commands, done instantly
+	switch (pTxBuf[0]) {
+	case CMD_1WRS:
+		SimOWReset(psC) ;
+		sSim.Stat |= psC->Count ? STATUS_PPD : 0 ;
+		break ;
+
+	case CMD_1WWB:
+		SimOWWriteByte(psC, Param) ;
+		break ;
+
+	case CMD_1WRB:
+		sSim.Data = SimOWReadByte(psC) ;
+		break ;
+
+	case CMD_1WSB:										// read slots return 1 once converted, PSU external
+		sSim.Stat |= ((Param & 0x80) && SimOWConverting(psC) == 0) ? STATUS_SBR : 0 ;
+		break ;
+
+	case CMD_1WT:
+		sSim.Stat |= SimOWTriplet(psC, (Param & 0x80) ? 1 : 0) ;
+		break ;
+
+	default:
+		return erFAILURE ;
+	}
+	return erSUCCESS ;
+}
+
+static int32_t	SimI2CRead(halI2Cdev_t * psI2Cdev, uint8_t * pRxBuf, size_t RxSize) {
+	if (psI2Cdev->addrI2C != ds2482ADDR_0) {
+		return erFAILURE ;
+	}
+	uint8_t	Value =	(sSim.Pntr == ds2482REG_DATA) ? sSim.Data :
+					(sSim.Pntr == ds2482REG_CHAN) ? SimChanRead[sSim.Chan] :
+					(sSim.Pntr == ds2482REG_CONF) ? sSim.Conf : sSim.Stat ;
+	memset(pRxBuf, Value, RxSize) ;						// ACK'ed reads repeat the register
+	return erSUCCESS ;
+}
+
+// ############################### hal & application stand-ins ####################################
+
+int32_t	halI2C_Write(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize) {
+	return SimI2CWrite(psI2Cdev, pTxBuf, TxSize) ;
+}
+
+int32_t	halI2C_Read(halI2Cdev_t * psI2Cdev, uint8_t * pRxBuf, size_t RxSize) {
+	return SimI2CRead(psI2Cdev, pRxBuf, RxSize) ;
+}
+
+int32_t	halI2C_WriteRead(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize, uint8_t * pRxBuf, size_t RxSize) {
+	int32_t	iRV = SimI2CWrite(psI2Cdev, pTxBuf, TxSize) ;
+	return (iRV == erSUCCESS) ? SimI2CRead(psI2Cdev, pRxBuf, RxSize) : iRV ;
+}
+
+void	vEpGetInfoWithIndex(ep_info_t * psEpInfo, int32_t xUri) {
+	psEpInfo->pEpStatic	= (xUri == URI_DS18X20) ? &sSimEpWork : NULL ;
+	psEpInfo->pEpWork	= (xUri == URI_DS18X20) ? &sSimEpWork : NULL ;
+}
+
+// ########################################## Verification #########################################
+
+static sim_dev_t *	SimFind(uint8_t Chan, uint64_t Value) {
+	for (int32_t i = 0; i < sSimChan[Chan].Count; ++i) {
+		if (sSimChan[Chan].psDev[i].ROM.Value == Value) {
+			return &sSimChan[Chan].psDev[i] ;
+		}
+	}
+	return NULL ;
+}
+
+/**
+ * SimVerify() - every sensor enumerated exactly once, on its own channel, last reading intact
+ * @return	number of errors
+ */
+static int32_t	SimVerify(int32_t Count, int32_t Channels) {
+	int32_t	Sensors = 0, Errors = 0 ;
+	for (int32_t Chan = 0; Chan < Channels; ++Chan) {
+		for (int32_t i = 0; i < sSimChan[Chan].Count; ++i) {
+			Sensors += (sSimChan[Chan].psDev[i].ROM.Family != OWFAMILY_01) ;
+		}
+	}
+	if (Fam10_28Count != Sensors) {
+		fprintf(stderr, "devices=%d: %d of %d sensors enumerated\n", Count, Fam10_28Count, Sensors) ;
+		++Errors ;
+	}
+	for (int32_t Idx = 0; Idx < Fam10_28Count; ++Idx) {
+		ds18x20_t * psTemp = &psDS18X20[Idx] ;
+		sim_dev_t * psDev = SimFind(psTemp->Ch, psTemp->ROM.Value) ;
+		if (psDev == NULL || psDev->Seen) {
+			fprintf(stderr, "devices=%d: sensor #%d unknown or duplicate\n", Count, Idx) ;
+			++Errors ;
+			continue ;
+		}
+		psDev->Seen = 1 ;
+		if (memcmp(psTemp->RegX, psDev->SP, 2) != 0) {
+			fprintf(stderr, "devices=%d: sensor #%d read %02X%02X expected %02X%02X\n", Count, Idx,
+					psTemp->Tmsb, psTemp->Tlsb, psDev->SP[1], psDev->SP[0]) ;
+			++Errors ;
+		}
+	}
+	return Errors ;
+}
+
+static int64_t	SimCPU(void) {
+	struct timespec sTS ;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &sTS) ;
+	return (int64_t) sTS.tv_sec * 1000000LL + sTS.tv_nsec / 1000 ;
+}
+
+// ############################################ Main ###############################################
+
+int		main(int argc, char * argv[]) {
+	static const int32_t Population[] = { 1, 2, 5, 10, 20, 50, 100, 150, 200 } ;
+	int32_t	Iter		= (argc > 1) ? atoi(argv[1]) : 0 ;
+	int32_t	MaxDev		= (argc > 2) ? atoi(argv[2]) : simMAX_DEV ;
+	int32_t	Channels	= (argc > 3) ? atoi(argv[3]) : 1 ;
+	if (MaxDev < 1 || MaxDev > simMAX_DEV || Channels < 1 || Channels > ds2482NUM_CHAN) {
+		fprintf(stderr, "Usage: %s [iterations [max devices (1..%d) [channels (1..%d)]]]\n", argv[0], simMAX_DEV, ds2482NUM_CHAN) ;
+		return 2 ;
+	}
+	vHostVirtualTime(1) ;
+	if (ds2482Identify(0, ds2482ADDR_0) != erSUCCESS) {
+		fprintf(stderr, "simulated DS2482 not identified\n") ;
+		return 1 ;
+	}
+	int32_t	Errors = 0, Count = 0 ;
+	printf("[\n") ;
+	for (int32_t p = 0; p < (int32_t) (sizeof(Population) / sizeof(Population[0])); ++p) {
+		if (Population[p] > MaxDev) {
+			break ;
+		}
+		if (Population[p] * Channels > UINT8_MAX) {		// Fam10_28Count limit
+			fprintf(stderr, "devices=%d x %d channels skipped, too many sensors\n", Population[p], Channels) ;
+			continue ;
+		}
+		SimPopulate(Population[p], Channels) ;
+		int64_t	CPU = SimCPU() ;
+		int32_t	iRV = ds2482Config() ;
+		CPU = SimCPU() - CPU ;
+		printf("%s{\"devices\":%d,\"channels\":%d,\"sensors\":%d,\"config_cpu_usec\":%u,\"results\":",
+				Count++ ? "," : "", Population[p], Channels, Fam10_28Count, (uint32_t) CPU) ;
+		if (iRV < erSUCCESS) {
+			fprintf(stderr, "devices=%d: configuration failed\n", Population[p]) ;
+			++Errors ;
+		}
+		ds2482Benchmark(Iter) ;
+		printf("}\n") ;
+		Errors += SimVerify(Population[p], Channels) ;
+	}
+	printf("]\n") ;
+	fprintf(stderr, "%u conversions, %s\n", Conversions, Errors ? "FAILED" : "PASSED") ;
+	return Errors ? 1 : 0 ;
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * ds2482trace.c - host side decoder/replay of a DS2482 I2C trace dump
+ *
+ * Build:	cc -O2 -o ds2482trace tools/ds2482trace.c
+ * Usage:	ds2482trace [file]		(stdin if no file)
+ *
+ * Input is either the binary image from ds2482TraceDump() or a console capture containing the
+ * "D2TR:" hex lines printed by ds2482TraceReport(), other lines are ignored.
+ * Every transaction is replayed against a model of the DS2482 read pointer, configuration and
+ * channel registers, flagging transactions that did not change the bridge state (redundant
+ * SRP, WCFG & CHSL) and reporting the time spent on them.
+ */
+
+#include	"../ds2482trace.h"
+
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<ctype.h>
+
+// ############################################# Macros ############################################
+
+#define	CMD_DRST							0xF0
+#define	CMD_SRP								0xE1
+#define	CMD_WCFG							0xD2
+#define	CMD_CHSL							0xC3
+#define	CMD_1WRS							0xB4
+#define	CMD_1WWB							0xA5
+#define	CMD_1WRB							0x96
+#define	CMD_1WSB							0x87
+#define	CMD_1WT								0x78
+
+#define	MAX_IMAGE							(1 << 20)
+
+// ######################################## Enumerations ###########################################
+
+enum { REG_STAT, REG_DATA, REG_CHAN, REG_CONF, REG_UNKNOWN } ;
+
+enum { RED_SRP, RED_WCFG, RED_CHSL, RED_NUM } ;
+
+// ######################################### Local data ############################################
+
+static const char * const RegName[] = { "STAT", "DATA", "CHAN", "CONF", "????" } ;
+static const char * const RedName[RED_NUM] = { "SRP", "WCFG", "CHSL" } ;
+
+static struct {											// model of the bridge state
+	int		Pntr ;
+	int		Conf ;										// -1 = unknown
+	int		Chan ;										// channel select code, -1 = unknown
+} sModel = { REG_UNKNOWN, -1, -1 } ;
+
+static unsigned	CmdCount[256] ;
+static unsigned	RedCount[RED_NUM] ;
+static unsigned	OpCount[3] ;
+static unsigned	Errors ;
+
+// ####################################### Local functions #########################################
+
+static int	RegFromCode(uint8_t Code) {
+	switch (Code) {
+	case 0xF0:	return REG_STAT ;
+	case 0xE1:	return REG_DATA ;
+	case 0xD2:	return REG_CHAN ;
+	case 0xC3:	return REG_CONF ;
+	default:	return REG_UNKNOWN ;
+	}
+}
+
+static const char * CmdName(uint8_t Cmd) {
+	switch (Cmd) {
+	case CMD_DRST:	return "DRST" ;
+	case CMD_SRP:	return "SRP" ;
+	case CMD_WCFG:	return "WCFG" ;
+	case CMD_CHSL:	return "CHSL" ;
+	case CMD_1WRS:	return "1WRS" ;
+	case CMD_1WWB:	return "1WWB" ;
+	case CMD_1WRB:	return "1WRB" ;
+	case CMD_1WSB:	return "1WSB" ;
+	case CMD_1WT:	return "1WT" ;
+	default:		return "????" ;
+	}
+}
+
+/**
+ * Replay() - apply one transaction to the model
+ * @return	RED_???? if the transaction did not change the model, else -1
+ */
+static int	Replay(const ds2482_trace_t * psTR) {
+	int	Red = -1 ;
+	if (psTR->Op == ds2482TR_READ || psTR->TxLen == 0) {
+		return Red ;									// reads do not change the state
+	}
+	uint8_t	Cmd = psTR->Tx[0], Par = psTR->Tx[1] ;
+	++CmdCount[Cmd] ;
+	switch (Cmd) {
+	case CMD_DRST:
+		sModel.Pntr = REG_STAT ;
+		sModel.Conf = 0 ;
+		sModel.Chan = 0xF0 ;							// channel 0 selected
+		break ;
+	case CMD_SRP:
+		if (sModel.Pntr == RegFromCode(Par)) {
+			Red = RED_SRP ;
+		}
+		sModel.Pntr = RegFromCode(Par) ;
+		break ;
+	case CMD_WCFG:
+		if (sModel.Conf == (Par & 0x0F)) {
+			Red = RED_WCFG ;
+		}
+		sModel.Conf = Par & 0x0F ;
+		sModel.Pntr = REG_CONF ;
+		break ;
+	case CMD_CHSL:
+		if (sModel.Chan == Par) {
+			Red = RED_CHSL ;
+		}
+		sModel.Chan = Par ;
+		sModel.Pntr = REG_CHAN ;
+		break ;
+	case CMD_1WRS:
+	case CMD_1WWB:
+	case CMD_1WRB:
+	case CMD_1WSB:
+	case CMD_1WT:
+		sModel.Pntr = REG_STAT ;
+		break ;
+	}
+	if (psTR->Result != 0) {							// failed, state no longer known
+		sModel.Pntr = REG_UNKNOWN ;
+		sModel.Conf = -1 ;
+		sModel.Chan = -1 ;
+		++Errors ;
+		Red = -1 ;
+	}
+	return Red ;
+}
+
+static size_t	LoadHex(const char * pText, uint8_t * pImage, size_t Max) {
+	size_t	Len = 0 ;
+	const char * pLine = pText ;
+	while ((pLine = strstr(pLine, "D2TR:")) != NULL) {
+		pLine += 5 ;
+		while (isxdigit((unsigned char) pLine[0]) && isxdigit((unsigned char) pLine[1]) && Len < Max) {
+			char	cBuf[3] = { pLine[0], pLine[1], 0 } ;
+			pImage[Len++] = (uint8_t) strtoul(cBuf, NULL, 16) ;
+			pLine += 2 ;
+		}
+	}
+	return Len ;
+}
+
+// ######################################### Main program ##########################################
+
+int	main(int argc, char * argv[]) {
+	FILE *	pFile = (argc > 1) ? fopen(argv[1], "rb") : stdin ;
+	if (pFile == NULL) {
+		perror(argv[1]) ;
+		return 1 ;
+	}
+	uint8_t * pRaw = malloc(MAX_IMAGE + 1) ;
+	uint8_t * pImage = malloc(MAX_IMAGE) ;
+	size_t	Len = fread(pRaw, 1, MAX_IMAGE, pFile) ;
+	pRaw[Len] = 0 ;
+	if (Len >= 5 && strstr((char *) pRaw, "D2TR:")) {
+		Len = LoadHex((char *) pRaw, pImage, MAX_IMAGE) ;
+	} else {
+		memcpy(pImage, pRaw, Len) ;
+	}
+
+	ds2482_trace_hdr_t sHdr ;
+	if (Len < sizeof(sHdr)) {
+		fprintf(stderr, "No trace found\n") ;
+		return 1 ;
+	}
+	memcpy(&sHdr, pImage, sizeof(sHdr)) ;
+	if (sHdr.Magic != ds2482TRACE_MAGIC || sHdr.Version != ds2482TRACE_VERSION) {
+		fprintf(stderr, "Bad magic/version %08X/%d\n", sHdr.Magic, sHdr.Version) ;
+		return 1 ;
+	}
+	size_t	Count = (Len - sizeof(sHdr)) / sizeof(ds2482_trace_t) ;
+	if (Count > sHdr.Count) {
+		Count = sHdr.Count ;
+	}
+
+	const char * OpName[3] = { "W ", "R ", "WR" } ;
+	uint32_t First = 0, Prev = 0 ;
+	for (size_t Idx = 0; Idx < Count; ++Idx) {
+		ds2482_trace_t	sTR ;
+		memcpy(&sTR, pImage + sizeof(sHdr) + Idx * sizeof(sTR), sizeof(sTR)) ;
+		if (Idx == 0) {
+			First = Prev = sTR.usecs ;
+		}
+		uint32_t Delta = sTR.usecs - Prev ;
+		int	PntrBefore = sModel.Pntr ;
+		int	Red = Replay(&sTR) ;
+		if (sTR.Op < 3) {
+			++OpCount[sTR.Op] ;
+		}
+		printf("%8u +%6u  %02X %s", sTR.usecs - First, Delta, sTR.Addr, OpName[sTR.Op % 3]) ;
+		if (sTR.TxLen) {
+			printf("  %-4s", CmdName(sTR.Tx[0])) ;
+			if (sTR.TxLen > 1) {
+				printf(" %02X", sTR.Tx[1]) ;
+			} else {
+				printf("   ") ;
+			}
+		} else {
+			printf("  %-4s   ", RegName[PntrBefore]) ;
+		}
+		for (int i = 0; i < sTR.RxLen && i < 2; ++i) {
+			printf("  <%02X", sTR.Rx[i]) ;
+		}
+		if (sTR.RxLen > 2) {
+			printf(" +%d", sTR.RxLen - 2) ;
+		}
+		if (sTR.Result) {
+			printf("  ERR=%d", sTR.Result) ;
+		}
+		if (Red >= 0) {
+			printf("  ** redundant %s", RedName[Red]) ;
+			++RedCount[Red] ;
+		}
+		printf("\n") ;
+		Prev = sTR.usecs ;
+	}
+
+	uint32_t Span = Prev - First ;
+	unsigned Total = OpCount[0] + OpCount[1] + OpCount[2] ;
+	printf("\n%zu transactions in %u uS (W=%u R=%u WR=%u) errors=%u\n", Count, Span,
+			OpCount[0], OpCount[1], OpCount[2], Errors) ;
+	for (int Cmd = 0; Cmd < 256; ++Cmd) {
+		if (CmdCount[Cmd]) {
+			printf("  %-4s %6u\n", CmdName(Cmd), CmdCount[Cmd]) ;
+		}
+	}
+	unsigned RedTotal = 0 ;
+	for (int Red = 0; Red < RED_NUM; ++Red) {
+		printf("Redundant %-4s %6u\n", RedName[Red], RedCount[Red]) ;
+		RedTotal += RedCount[Red] ;
+	}
+	if (Total) {
+		printf("Redundant total %u (%u%% of transactions, ~%u uS at the average cost)\n", RedTotal,
+				(RedTotal * 100) / Total, Count > 1 ? (unsigned) ((uint64_t) Span * RedTotal / Count) : 0) ;
+	}
+	free(pRaw) ;
+	free(pImage) ;
+	return 0 ;
+}
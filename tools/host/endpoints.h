@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * endpoints.h - host (Linux) stand-in for the endpoint tables a family driver reports into
+ *
+ * The program provides vEpGetInfoWithIndex() for the URI_???? listed here.
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	URI_DS18X20							1
+
+// ######################################### Structures ############################################
+
+typedef struct ep_work_s {
+	struct {
+		struct {
+			struct {
+				uint32_t	varcount ;
+				uint8_t		pntr ;
+			} cv ;
+		} varDef ;
+		struct {
+			void *		pvoid ;
+		} varVal ;
+	} Var ;
+} ep_work_t ;
+
+typedef struct ep_info_t {
+	const void *	pEpStatic ;
+	ep_work_t *		pEpWork ;
+} ep_info_t ;
+
+// ###################################### Public functions #########################################
+
+void	vEpGetInfoWithIndex(ep_info_t * psEpInfo, int32_t xUri) ;
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * FreeRTOS.h - host (Linux) stand-in for the FreeRTOS API used by the component
+ *
+ * Tasks are pthreads, mutexes are recursive pthread mutexes and a tick is 1mS of CLOCK_MONOTONIC.
+ * With virtual time enabled vTaskDelay() advances the tick count instead of sleeping, so a
+ * simulation is not paced by the bridge's 1-Wire timing.
+ * A handle is an index into a table (hostrtos.c), not a pointer, so it stays 32 bit and the
+ * packed structure size checks made for the ESP32 hold on a 64 bit host.
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	configTICK_RATE_HZ					1000
+#define	portTICK_PERIOD_MS					(1000 / configTICK_RATE_HZ)
+#define	portMAX_DELAY						((TickType_t) 0xFFFFFFFF)
+#define	pdMS_TO_TICKS(x)					((TickType_t) ((x) * configTICK_RATE_HZ / 1000))
+
+#define	pdFALSE								0
+#define	pdTRUE								1
+#define	pdFAIL								pdFALSE
+#define	pdPASS								pdTRUE
+
+#define	portMUX_INITIALIZER_UNLOCKED		{ 0 }
+#define	portENTER_CRITICAL(x)				vHostCritical(1)
+#define	portEXIT_CRITICAL(x)				vHostCritical(0)
+#define	taskYIELD()							vHostYield()
+
+// ######################################### Structures ############################################
+
+typedef	uint32_t	TickType_t ;
+typedef	int32_t		BaseType_t ;
+typedef	uint32_t	UBaseType_t ;
+typedef	uint32_t	SemaphoreHandle_t ;
+typedef	void *		TaskHandle_t ;
+typedef	struct { int32_t Dummy ; } portMUX_TYPE ;
+
+// ###################################### Public functions #########################################
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) ;
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) ;
+void	vSemaphoreDelete(SemaphoreHandle_t xSem) ;
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSem, TickType_t xTicks) ;
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSem) ;
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xSem, TickType_t xTicks) ;
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xSem) ;
+BaseType_t xRtosSemaphoreTake(SemaphoreHandle_t * pSem, TickType_t xTicks) ;
+BaseType_t xRtosSemaphoreGive(SemaphoreHandle_t * pSem) ;
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSem) ;
+TaskHandle_t xTaskGetCurrentTaskHandle(void) ;
+TickType_t xTaskGetTickCount(void) ;
+void	vTaskDelay(TickType_t xTicks) ;
+void	vHostCritical(int32_t Enter) ;
+void	vHostYield(void) ;
+void	vHostVirtualTime(int32_t Enable) ;
+uint64_t xHostVirtualMillis(void) ;						// total mS skipped by vTaskDelay()
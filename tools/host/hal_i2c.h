@@ -0,0 +1,50 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * hal_i2c.h - host (Linux) stand-in for the I2C hal
+ *
+ * Implemented by ../../hal_i2c_linux.c on a real adapter (/dev/i2c-N) or by a simulated bridge
+ * in the program itself (ds2482sim.c).
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+#include	<stddef.h>
+
+// ############################################# Macros ############################################
+
+#define	halI2C_NUM							16
+
+// ######################################### Structures ############################################
+
+typedef struct __attribute__((packed)) halI2Cdev_t {
+	uint8_t		chanI2C ;
+	uint8_t		addrI2C ;
+	uint32_t	dlayI2C ;
+	uint32_t	speed ;
+} halI2Cdev_t ;
+
+// ###################################### Public functions #########################################
+
+int32_t	halI2C_Write(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize) ;
+int32_t	halI2C_Read(halI2Cdev_t * psI2Cdev, uint8_t * pRxBuf, size_t RxSize) ;
+int32_t	halI2C_WriteRead(halI2Cdev_t * psI2Cdev, uint8_t * pTxBuf, size_t TxSize, uint8_t * pRxBuf, size_t RxSize) ;
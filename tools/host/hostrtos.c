@@ -0,0 +1,177 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * hostrtos.c - host (Linux) implementation of the FreeRTOS, printf, syslog & timestamp stand-ins
+ */
+
+#include	"freertos/FreeRTOS.h"
+#include	"printfx.h"
+#include	"syslog.h"
+#include	"systiming.h"
+
+#include	<pthread.h>
+#include	<stdarg.h>
+#include	<stdio.h>
+#include	<time.h>
+
+// ############################################# Macros ############################################
+
+#define	hostMAX_SEM							32
+
+// ######################################### Local data ############################################
+
+static struct {
+	pthread_mutex_t	Mux ;
+	pthread_t		Holder ;
+	int32_t			Depth ;
+} sHostSem[hostMAX_SEM + 1] ;							// handle 0 is NULL
+
+static uint32_t			HostSemCount ;
+static pthread_mutex_t	HostLock = PTHREAD_MUTEX_INITIALIZER ;
+static int32_t			HostVirtual ;
+static uint64_t			HostSkipped ;					// mS added by vTaskDelay() in virtual time
+
+// ####################################### Global variables ########################################
+
+tsz_t	sTSZ ;
+
+// ####################################### Local functions #########################################
+
+static uint64_t	xHostMillis(void) {
+	struct timespec sTS ;
+	clock_gettime(CLOCK_MONOTONIC, &sTS) ;
+	return (uint64_t) sTS.tv_sec * 1000ULL + sTS.tv_nsec / 1000000 ;
+}
+
+// ###################################### Public functions #########################################
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+	pthread_mutex_lock(&HostLock) ;
+	SemaphoreHandle_t xSem = (HostSemCount < hostMAX_SEM) ? ++HostSemCount : 0 ;
+	pthread_mutex_unlock(&HostLock) ;
+	if (xSem) {
+		pthread_mutexattr_t	sAttr ;
+		pthread_mutexattr_init(&sAttr) ;
+		pthread_mutexattr_settype(&sAttr, PTHREAD_MUTEX_RECURSIVE) ;
+		pthread_mutex_init(&sHostSem[xSem].Mux, &sAttr) ;
+		pthread_mutexattr_destroy(&sAttr) ;
+	}
+	return xSem ;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return xSemaphoreCreateRecursiveMutex() ; }
+
+void	vSemaphoreDelete(SemaphoreHandle_t xSem) {
+	if (xSem && xSem <= hostMAX_SEM) {					// slot is not reused
+		pthread_mutex_destroy(&sHostSem[xSem].Mux) ;
+	}
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t xSem, TickType_t xTicks) {
+	if (xSem == 0 || xSem > hostMAX_SEM) {
+		return pdFAIL ;
+	}
+	if (xTicks == portMAX_DELAY) {
+		pthread_mutex_lock(&sHostSem[xSem].Mux) ;
+	} else {
+		TickType_t	Start = xTaskGetTickCount() ;
+		while (pthread_mutex_trylock(&sHostSem[xSem].Mux) != 0) {
+			if ((xTaskGetTickCount() - Start) >= xTicks) {
+				return pdFAIL ;
+			}
+			vTaskDelay(1) ;
+		}
+	}
+	sHostSem[xSem].Holder = pthread_self() ;
+	++sHostSem[xSem].Depth ;
+	return pdPASS ;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t xSem) {
+	if (xSem == 0 || xSem > hostMAX_SEM) {
+		return pdFAIL ;
+	}
+	--sHostSem[xSem].Depth ;
+	return (pthread_mutex_unlock(&sHostSem[xSem].Mux) == 0) ? pdPASS : pdFAIL ;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSem, TickType_t xTicks) { return xSemaphoreTakeRecursive(xSem, xTicks) ; }
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSem) { return xSemaphoreGiveRecursive(xSem) ; }
+
+BaseType_t xRtosSemaphoreTake(SemaphoreHandle_t * pSem, TickType_t xTicks) { return xSemaphoreTakeRecursive(*pSem, xTicks) ; }
+
+BaseType_t xRtosSemaphoreGive(SemaphoreHandle_t * pSem) { return xSemaphoreGiveRecursive(*pSem) ; }
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSem) {
+	if (xSem == 0 || xSem > hostMAX_SEM || sHostSem[xSem].Depth == 0) {
+		return NULL ;
+	}
+	return (TaskHandle_t) sHostSem[xSem].Holder ;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return (TaskHandle_t) pthread_self() ; }
+
+TickType_t xTaskGetTickCount(void) {
+	return (TickType_t) ((xHostMillis() + __atomic_load_n(&HostSkipped, __ATOMIC_RELAXED)) / portTICK_PERIOD_MS) ;
+}
+
+void	vTaskDelay(TickType_t xTicks) {
+	if (HostVirtual) {
+		__atomic_fetch_add(&HostSkipped, (uint64_t) xTicks * portTICK_PERIOD_MS, __ATOMIC_RELAXED) ;
+		sched_yield() ;
+		return ;
+	}
+	struct timespec sTS = { xTicks * portTICK_PERIOD_MS / 1000, (xTicks * portTICK_PERIOD_MS % 1000) * 1000000L } ;
+	nanosleep(&sTS, NULL) ;
+}
+
+void	vHostCritical(int32_t Enter) {
+	if (Enter) {
+		pthread_mutex_lock(&HostLock) ;
+	} else {
+		pthread_mutex_unlock(&HostLock) ;
+	}
+}
+
+void	vHostYield(void) { sched_yield() ; }
+
+void	vHostVirtualTime(int32_t Enable) { HostVirtual = Enable ; }
+
+uint64_t xHostVirtualMillis(void) { return __atomic_load_n(&HostSkipped, __ATOMIC_RELAXED) ; }
+
+int		xprintf(const char * pFmt, ...) {
+	va_list	vArgs ;
+	va_start(vArgs, pFmt) ;
+	int	iRV = vfprintf(stderr, pFmt, vArgs) ;
+	va_end(vArgs) ;
+	return iRV ;
+}
+
+int		xsyslog(const char * pLevel, const char * pFunc, const char * pFmt, ...) {
+	fprintf(stderr, "%s %s: ", pLevel, pFunc) ;
+	va_list	vArgs ;
+	va_start(vArgs, pFmt) ;
+	int	iRV = vfprintf(stderr, pFmt, vArgs) ;
+	va_end(vArgs) ;
+	fputc('\n', stderr) ;
+	return iRV ;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * syslog.h - host (Linux) stand-in, messages go to stderr
+ */
+
+#pragma		once
+
+int		xsyslog(const char * pLevel, const char * pFunc, const char * pFmt, ...) ;
+
+#define	SL_ERR(...)							xsyslog("ERR", __FUNCTION__, __VA_ARGS__)
+#define	SL_WARN(...)						xsyslog("WARN", __FUNCTION__, __VA_ARGS__)
+#define	SL_NOT(...)							xsyslog("NOT", __FUNCTION__, __VA_ARGS__)
+#define	SL_INFO(...)						xsyslog("INFO", __FUNCTION__, __VA_ARGS__)
+#define	IF_SL_ERR(f, ...)					do { if (f) { SL_ERR(__VA_ARGS__) ; } } while (0)
+#define	IF_SL_INFO(f, ...)					do { if (f) { SL_INFO(__VA_ARGS__) ; } } while (0)
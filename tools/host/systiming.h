@@ -0,0 +1,46 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * systiming.h - host (Linux) stand-in, the timing debug hooks compile away and the system
+ * timestamp is maintained by hostrtos.c
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+
+// ############################################# Macros ############################################
+
+#define	IF_SYSTIMER_INIT(f, ...)
+#define	IF_SYSTIMER_START(f, ...)
+#define	IF_SYSTIMER_STOP(f, ...)
+
+// ######################################### Structures ############################################
+
+typedef	uint32_t	seconds_t ;
+
+typedef struct tsz_t {
+	uint64_t	usecs ;
+} tsz_t ;
+
+// ####################################### Global variables ########################################
+
+extern	tsz_t	sTSZ ;
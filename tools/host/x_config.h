@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * x_config.h - host (Linux) build configuration for the programs in tools/
+ *
+ * Stands in for the application level x_config.h so the bridge, bus and core 1-Wire sources
+ * build and run on a PC. Each program lists the sources it needs in its "Build:" line.
+ */
+
+#pragma		once
+
+#define	ESP32_PLATFORM						0
+
+#ifndef	halHAS_DS2482_100
+	#define	halHAS_DS2482_100				0
+#endif
+#ifndef	halHAS_DS2482_800
+	#define	halHAS_DS2482_800				1
+#endif
+#ifndef	halHAS_DS2484
+	#define	halHAS_DS2484					0
+#endif
+#ifndef	halHAS_DS2480B
+	#define	halHAS_DS2480B					1
+#endif
+
+// family drivers & hardware that need the rest of the application are left out by default,
+// a program enabling one (-DhalHAS_DS18X20=1) provides what it needs
+#ifndef	halHAS_DS1990X
+	#define	halHAS_DS1990X					0
+#endif
+#ifndef	halHAS_DS18X20
+	#define	halHAS_DS18X20					0
+#endif
+#ifndef	halHAS_DS2408
+	#define	halHAS_DS2408					0
+#endif
+#ifndef	halHAS_DS2409
+	#define	halHAS_DS2409					0
+#endif
+#ifndef	halHAS_DS2450
+	#define	halHAS_DS2450					0
+#endif
+#ifndef	halHAS_OWMEM
+	#define	halHAS_OWMEM					0
+#endif
+#ifndef	halHAS_OWLOG
+	#define	halHAS_OWLOG					0
+#endif
+#ifndef	halHAS_PCA9555
+	#define	halHAS_PCA9555					0
+#endif
+
+// results of the programs go to stdout, the component's console output (xprintf) to stderr
+#define	ds2482BENCH_OUT(...)				printf(__VA_ARGS__)
+
+#include	"x_definitions.h"
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * x_definitions.h - host (Linux) stand-in for the common definitions used by the component
+ */
+
+#pragma		once
+
+#include	"freertos/FreeRTOS.h"
+
+#include	<assert.h>
+#include	<stdint.h>
+#include	<stddef.h>
+#include	<stdlib.h>
+#include	<limits.h>
+#include	<stdbool.h>
+
+// ############################################# Macros ############################################
+
+#define	DUMB_STATIC_ASSERT(x)				_Static_assert(x, #x)
+
+#define	erSUCCESS							0
+#define	erFAILURE							-1
+
+#define	BITS_IN_BYTE						8
+#define	SIZEOF_MEMBER(t, m)					sizeof(((t *) 0)->m)
+
+#define	INRANGE(l, v, h, t)					((t) (l) <= (t) (v) && (t) (v) <= (t) (h))
+#define	INRANGE_SRAM(p)						((p) != NULL)
+#define	INRANGE_FLASH(p)					((p) != NULL)
+
+#define	myASSERT(x)							assert(x)
+#define	IF_myASSERT(f, x)					do { if (f) { assert(x) ; } } while (0)
+
+#define	EQ_RETURN(x, y)						if ((x) == (y)) { return (x) ; }
+#define	NE_RETURN(x, y)						if ((x) != (y)) { return (x) ; }
+#define	LT_RETURN(x, y)						if ((x) < (y)) { return (x) ; }
+#define	GT_RETURN(x, y)						if ((x) > (y)) { return (x) ; }
+#define	EQ_BREAK(x, y)						if ((x) == (y)) { break ; }
+#define	LT_BREAK(x, y)						if ((x) < (y)) { break ; }
+#define	NE_GOTO(x, y, l)					if ((x) != (y)) { goto l ; }
+#define	LT_GOTO(x, y, l)					if ((x) < (y)) { goto l ; }
+
+#define	IF_EXEC_1(f, x, a)					do { if (f) { x(a) ; } } while (0)
+#define	IF_EXEC_2(f, x, a, b)				do { if (f) { x(a, b) ; } } while (0)
+
+#define	myMS_TO_TICKS(x)					pdMS_TO_TICKS(x)
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2014-19 AM Maree/KSS Technologies (Pty) Ltd.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+ * x_values_convert.h - host (Linux) stand-in for the value conversion helpers
+ */
+
+#pragma		once
+
+#include	<stdint.h>
+
+// ######################################### Structures ############################################
+
+typedef struct complex_t {
+	float	(* read)(int32_t) ;
+	void *	mode ;
+} complex_t ;
+
+// ###################################### Public functions #########################################
+
+/**
+ * xConvert2sComp() - sign extend the 2's complement value held in the low Bits of Value
+ */
+static inline int32_t xConvert2sComp(int32_t Value, int32_t Bits) {
+	uint32_t	Sign = 1UL << (Bits - 1) ;
+	Value &= (int32_t) ((Sign << 1) - 1) ;
+	return (int32_t) ((uint32_t) Value ^ Sign) - (int32_t) Sign ;
+}